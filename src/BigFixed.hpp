@@ -0,0 +1,573 @@
+#ifndef BIGFIXED_HPP_
+#define BIGFIXED_HPP_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <array>
+#include <limits>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#include "bign_supplemental.hpp"
+#include "BigN.hpp"
+
+/**
+ * \file
+ * \brief The BigFixed class—a decimal fixed-point number of a fixed width, which needs no heap.
+ */
+
+namespace BigNum {
+using namespace std;
+
+/**\brief A Decimal Fixed-Point Number of N Digits, Scale of Them Behind the Decimal Point
+The magnitude is kept multiplied by 10^Scale, as an integer in a std::array of BigN cells (most significant first), so unlike BigN, it has no heap storage, no beg_ and no scales to align.
+All of its arithmetic goes through the same, compile-time number of cells: sums, differences and comparisons are constant expressions, unrolled over the cells; products are long multiplications, and quotients are computed by BigN's long division, on cells on the stack.
+Products, quotients and numbers read in are rounded to Scale digits by *rounding*; the scale is fixed, so set_precision() only sets *rounding*; results with more than N-Scale digits before the decimal point throw exOverflow (and leave the operands as they are).
+Native integers construct it, and +, - and the comparisons combine it, in constant expressions.
+\tparam N The number of decimal digits
+\tparam Scale How many of them are behind the decimal point
+\tparam S The type of the cells
+\note Meant for widths of a few cells: a product takes ncells^2 cell products.
+*/
+template<unsigned N, unsigned Scale, typename S=u64>
+class BigFixed {
+     static_assert(N>0 && Scale<=N, "There must be a digit, and the scale can't have more.");
+     ///BigN provides the kernels for the cells
+     typedef BigN<S> Kernels;
+public:
+     enum esign { PLUS=0, MINUS=1 };
+     enum {
+          cshift10d=CellDigits<S>::n,				///<The capacity of a cell in decimal digits
+          ncells=(N+cshift10d-1)/cshift10d,			///<Cells of the magnitude
+          scale_cells=Scale/cshift10d,				///<Whole cells behind the decimal point
+          wide_cells=ncells+scale_cells+1,			///<Cells of a magnitude times 10^Scale
+          chars_max=N+2						///<The most characters to_chars() writes
+     };
+     enum {
+          cshift=Pow(10,cshift10d),				///<The radix of the cells
+          top_limit=Pow(10,N-(ncells-1)*cshift10d),		///<The first cell stays below this
+          scale_mul=Pow(10,Scale%cshift10d)			///<Multiplying by this shifts by what Scale has beyond whole cells
+     };
+     typedef typename CellWideType<S>::type WideST;
+     typedef array<S,ncells> Cells;
+     typedef typename Kernels::exDivByZero exDivByZero;
+     ///Thrown when a result has more than N-Scale digits before the decimal point
+     struct exOverflow : runtime_error {
+          exOverflow() : runtime_error("Fixed-point overflow") {}
+     };
+     ///How products, quotients and numbers read in are rounded to Scale digits
+     static round_mode rounding;
+     ///Sets rounding to *mode*; the scale is fixed at Scale, which this returns whatever scale is asked for
+     friend long set_precision(const BigFixed&, long, round_mode mode) {
+          rounding=mode;
+          return Scale;
+     }
+private:
+     ///The magnitude times 10^Scale
+     Cells v_;
+     esign sign_;
+
+     /**\name Constant Expressions
+     Build the cells of a native integer at compile time.
+     @{*/
+     ///m, unless it has more than N-Scale digits
+     static constexpr u64 _fits(u64 m) {
+          return N-Scale>=20 || m<pten[N-Scale] ? m : throw exOverflow();
+     }
+     template<typename T>
+     static constexpr u64 _int_abs(T y) {
+          return _fits(y<0 ? u64(0)-u64(y) : u64(y));
+     }
+     ///The cell of m*10^Scale whose last digit has the weight 10^(lo+Scale)
+     static constexpr S _int_cell(u64 m, long lo) {
+          return lo>=20 || lo<=-long(cshift10d) ? 0 : lo>=0 ? S(m/pten[lo]%cshift) : S(m%pten[cshift10d+lo]*pten[-lo]);
+     }
+     template<long... I>
+     static constexpr Cells _int_cells(u64 m, Indices<I...>) {
+          return Cells{{_int_cell(m,long(ncells-1-I)*cshift10d-long(Scale))...}};
+     }
+     ///@}
+
+     /**\name Magnitude Kernels
+     Go through all ncells cells. _cmp(), _add() and _sub() are constant expressions: they recurse on the cell index as a template argument, so that they are unrolled, and _add() and _sub() carry the cells found so far along as a pack. _add_to() and _sub_from() are their in-place loops, for += and -=.
+     @{*/
+     ///Compares a and b from cell K on
+     template<long K>
+     static constexpr int _cmp(const Cells& a, const Cells& b, integral_constant<long,K>) {
+          return a[K]!=b[K] ? (a[K]>b[K] ? 1 : -1) : _cmp(a,b,integral_constant<long,K+1>());
+     }
+     static constexpr int _cmp(const Cells&, const Cells&, integral_constant<long,ncells>) {
+          return 0;
+     }
+     static constexpr int _cmp(const Cells& a, const Cells& b) {
+          return _cmp(a,b,integral_constant<long,0>());
+     }
+     ///c, unless it has more than N digits
+     static constexpr Cells _fits(const Cells& c) {
+          return c[0]>=S(top_limit) ? throw exOverflow() : c;
+     }
+     ///The cells of a+b, cells K+1.. being c...; throws exOverflow if the sum has more than N digits
+     template<long K, typename... T>
+     static constexpr Cells _add(const Cells& a, const Cells& b, integral_constant<long,K>, S carry, T... c) {
+          return _add_cell(a,b,integral_constant<long,K>(),S(a[K]+b[K]+carry),c...);
+     }
+     ///Goes on with _add(), t being the sum of cell K and the carry into it
+     template<long K, typename... T>
+     static constexpr Cells _add_cell(const Cells& a, const Cells& b, integral_constant<long,K>, S t, T... c) {
+          return _add(a,b,integral_constant<long,K-1>(),S(t>=S(cshift)),S(t>=S(cshift) ? t-S(cshift) : t),c...);
+     }
+     template<typename... T>
+     static constexpr Cells _add(const Cells&, const Cells&, integral_constant<long,-1>, S carry, T... c) {
+          return carry ? throw exOverflow() : _fits(Cells{{c...}});
+     }
+     static constexpr Cells _add(const Cells& a, const Cells& b) {
+          return _add(a,b,integral_constant<long,ncells-1>(),S(0));
+     }
+     ///The cells of a-b (a>=b), cells K+1.. being c...
+     template<long K, typename... T>
+     static constexpr Cells _sub(const Cells& a, const Cells& b, integral_constant<long,K>, S borrow, T... c) {
+          return _sub_cell(a,b,integral_constant<long,K>(),S(b[K]+borrow),c...);
+     }
+     ///Goes on with _sub(), t being cell K of b plus the borrow from it
+     template<long K, typename... T>
+     static constexpr Cells _sub_cell(const Cells& a, const Cells& b, integral_constant<long,K>, S t, T... c) {
+          return _sub(a,b,integral_constant<long,K-1>(),S(a[K]<t),S(a[K]<t ? a[K]+S(cshift)-t : a[K]-t),c...);
+     }
+     template<typename... T>
+     static constexpr Cells _sub(const Cells&, const Cells&, integral_constant<long,-1>, S, T... c) {
+          return Cells{{c...}};
+     }
+     static constexpr Cells _sub(const Cells& a, const Cells& b) {
+          return _sub(a,b,integral_constant<long,ncells-1>(),S(0));
+     }
+     ///Adds b to a in place, as _add() does; throws exOverflow (leaving a alone)
+     static void _add_to(Cells& a, const Cells& b) {
+          Cells c;
+          S carry=0;
+          for(long i=ncells-1; i>=0; --i) {
+               S t=S(a[i]+b[i]+carry);
+               carry= t>=S(cshift);
+               c[i]= carry ? S(t-cshift) : t;
+          }
+          if(carry || c[0]>=S(top_limit))
+               throw exOverflow();
+          a=c;
+     }
+     ///Subtracts b from a (a>=b) in place
+     static void _sub_from(Cells& a, const Cells& b) {
+          S borrow=0;
+          for(long i=ncells-1; i>=0; --i) {
+               S t=S(b[i]+borrow);
+               borrow= a[i]<t;
+               a[i]=S(a[i]+(borrow ? S(cshift) : S(0))-t);
+          }
+     }
+     constexpr bool _is_zero() const {
+          return !_cmp(v_,Cells());
+     }
+     ///Writes all 2*ncells cells of a*b to p
+     static void _mul(const Cells& a, const Cells& b, S* p) {
+          fill(p,p+2*ncells,S(0));
+          for(long i=ncells-1; i>=0; --i) {
+               WideST carry=0;
+               for(long j=ncells-1; j>=0; --j) {
+                    WideST t=WideST(a[i])*b[j]+p[i+j+1]+carry;
+                    p[i+j+1]=S(t%cshift);
+                    carry=t/cshift;
+               }
+               p[i]=S(carry);
+          }
+     }
+     ///Adds one to the last digit of the magnitude
+     void _inc() {
+          Cells one=Cells();
+          one[ncells-1]=1;
+          _add_to(v_,one);
+     }
+     ///@}
+     ///Sets the magnitude to the n cells of c (n>=ncells); throws exOverflow (leaving it alone) if they have more than N digits
+     void _assign(const S* c, long n) {
+          for(long i=0; i<n-ncells; ++i)
+               if(c[i])
+                    throw exOverflow();
+          if(c[n-ncells]>=S(top_limit))
+               throw exOverflow();
+          copy(c+n-ncells,c+n,v_.begin());
+     }
+     ///Writes the cn (<=ncells) cells of c times 10^Scale to the wide_cells cells of u
+     static void _upscale(const S* c, long cn, S* u) {
+          fill(u,u+wide_cells,S(0));
+          copy(c,c+cn,u+wide_cells-scale_cells-cn);
+          Kernels::_cells_mul1(u,wide_cells-scale_cells,S(scale_mul));
+     }
+     static void _div_cells(const S* u, long un, const S* v, S* q, Cells& r);
+     static void _divmod(const BigFixed& x, const BigFixed& y, BigFixed* q, BigFixed* r);
+     ///What the last Scale digits of the n cells of c (of which the last has the weight 1) are, as round_away() takes it
+     static int _cut_rest(const S* c, long n) {
+          if(!Scale)
+               return 0;
+          const long w=Scale-1, i=n-1-w/cshift10d;
+          bool sticky= c[i]%pten[w%cshift10d]!=0;
+          for(long k=i+1; k<n && !sticky; ++k)
+               sticky= c[k]!=0;
+          return cut_rest(short(c[i]/pten[w%cshift10d]%10),sticky);
+     }
+     ///Rounds the magnitude up by a digit if round_away() says so
+     void _round(int rest) {
+          if(round_away(rounding,rest,v_[ncells-1]%2,sign_==MINUS))
+               _inc();
+          if(_is_zero())
+               sign_=PLUS;
+     }
+     ///The magnitude v with the sign s; zero gets PLUS
+     constexpr BigFixed(const Cells& v, esign s) : v_(v), sign_(_cmp(v,Cells()) ? s : PLUS) {}
+     u64 _int_part_abs() const;
+     ///The integral part, truncated toward zero and saturated at the limits of T
+     template<typename T>
+     T _to_native(true_type) const {
+          u64 m=_int_part_abs(), hi=u64(numeric_limits<T>::max());
+          if(sign_==PLUS)
+               return m>hi ? numeric_limits<T>::max() : T(m);
+          if(!numeric_limits<T>::is_signed)
+               return 0;
+          return m>hi ? numeric_limits<T>::min() : T(-T(m));
+     }
+     ///The nearest value, as BigN converts it
+     template<typename F>
+     F _to_native(false_type) const {
+          char buf[chars_max];
+          Kernels t;
+          t.read(buf,to_chars(buf,buf+sizeof buf));
+          return F(t);
+     }
+     ///+= (or -= if sub is true) in place, by _add_to() and _sub_from(); the sign flips if a greater magnitude is subtracted
+     BigFixed& _addsub(const BigFixed& y, bool sub) {
+          if((sign_!=y.sign_)==sub) {
+               _add_to(v_,y.v_);
+               return *this;
+          }
+          if(_cmp(v_,y.v_)>=0)
+               _sub_from(v_,y.v_);
+          else {
+               Cells t=y.v_;
+               _sub_from(t,v_);
+               v_=t;
+               sign_= sign_==PLUS ? MINUS : PLUS;
+          }
+          if(_is_zero())
+               sign_=PLUS;
+          return *this;
+     }
+public:
+     ///Zero
+     constexpr BigFixed() : v_(), sign_(PLUS) {}
+     ///Construct from native integers, in constant expressions too; throws exOverflow if they have more than N-Scale digits
+     template<typename T>
+     constexpr BigFixed(T x, typename enable_if<is_integral<T>::value>::type* =0) :
+          v_(_int_cells(_int_abs(x),typename MakeIndices<ncells>::type())), sign_(x<0 ? MINUS : PLUS) {}
+     ///Read in from a boolean (true==1, false==0)
+     constexpr BigFixed(bool b) : v_(_int_cells(b,typename MakeIndices<ncells>::type())), sign_(PLUS) {}
+     ///Construct from floating point numbers, whose binary value is read exactly (see BigN) and then rounded by *rounding*
+     template<typename T>
+     BigFixed(T x, typename enable_if<is_floating_point<T>::value>::type* =0) : sign_(PLUS) {
+          string s=to_string(Kernels(x));
+          read(s.data(),s.data()+s.size());
+     }
+     ///Read from an input string by read()
+     BigFixed(const char* istr) : sign_(PLUS) {
+          read(istr,istr+strlen(istr));
+     }
+     BigFixed(istream& is) : v_(), sign_(PLUS) {
+          is>>*this;
+     }
+     template<typename T, typename=typename enable_if<is_arithmetic<T>::value>::type>
+     BigFixed& operator=(T x) {
+          return *this=BigFixed(x);
+     }
+
+     explicit constexpr operator bool() const {
+          return !_is_zero();
+     }
+     ///Integers get the integral part, truncated toward zero and saturated at the limits of their type; floating point types get the correctly rounded value
+     template<typename T, typename=typename enable_if<is_arithmetic<T>::value && !is_same<T,bool>::value>::type>
+     explicit operator T() const {
+          return _to_native<T>(integral_constant<bool,numeric_limits<T>::is_integer>());
+     }
+
+     ///Returns a value >0 if *this>y, 0 if *this==y, and a value <0 if *this<y
+     constexpr int compare(const BigFixed& y) const {
+          return sign_!=y.sign_ ? (sign_==MINUS ? -1 : 1) : sign_==MINUS ? -_cmp(v_,y.v_) : _cmp(v_,y.v_);
+     }
+///Macro to write the comparison operators
+#define BFIX_CMP_(X) friend constexpr bool operator X (const BigFixed& x, const BigFixed& y) { return x.compare(y) X 0; }
+     BFIX_CMP_(==)
+     BFIX_CMP_(!=)
+     BFIX_CMP_(<)
+     BFIX_CMP_(>)
+     BFIX_CMP_(<=)
+     BFIX_CMP_(>=)
+#undef BFIX_CMP_
+
+     friend constexpr BigFixed operator-(const BigFixed& x) {
+          return BigFixed(x.v_,x.sign_==PLUS ? MINUS : PLUS);
+     }
+     constexpr BigFixed operator+() const {
+          return *this;
+     }
+     ///The sum; throws exOverflow if it has more than N-Scale digits before the decimal point
+     friend constexpr BigFixed operator+(const BigFixed& x, const BigFixed& y) {
+          return x.sign_==y.sign_ ? BigFixed(_add(x.v_,y.v_),x.sign_)
+               : _cmp(x.v_,y.v_)>=0 ? BigFixed(_sub(x.v_,y.v_),x.sign_) : BigFixed(_sub(y.v_,x.v_),y.sign_);
+     }
+     friend constexpr BigFixed operator-(const BigFixed& x, const BigFixed& y) {
+          return x+-y;
+     }
+     BigFixed& operator+=(const BigFixed& y) {
+          return _addsub(y,false);
+     }
+     BigFixed& operator-=(const BigFixed& y) {
+          return _addsub(y,true);
+     }
+     BigFixed& operator++() {
+          return *this+=1;
+     }
+     BigFixed& operator--() {
+          return *this-=1;
+     }
+     ///The product, rounded to Scale digits; throws exOverflow (leaving *this alone) if it doesn't fit
+     BigFixed& operator*=(const BigFixed& y) {
+          S p[2*ncells];
+          _mul(v_,y.v_,p);
+          int rest=_cut_rest(p,2*ncells);
+          Kernels::_cells_div1(p,2*ncells-scale_cells,S(scale_mul));
+          BigFixed t;
+          t._assign(p,2*ncells-scale_cells);
+          t.sign_= sign_==y.sign_ ? PLUS : MINUS;
+          t._round(rest);
+          return *this=t;
+     }
+     ///The quotient, rounded to Scale digits. Throws exDivByZero if y is zero, and exOverflow (leaving *this alone) if it doesn't fit.
+     BigFixed& operator/=(const BigFixed& y) {
+          if(!y)
+               throw exDivByZero();
+          S u[wide_cells], q[wide_cells];
+          Cells r, h=y.v_;
+          _upscale(v_.data(),ncells,u);
+          _div_cells(u,wide_cells,y.v_.data(),q,r);
+          //The remainder against half of the divisor
+          _sub_from(h,r);
+          int c=_cmp(r,h), rest= !_cmp(r,Cells()) ? 0 : c<0 ? 1 : c==0 ? 2 : 3;
+          BigFixed t;
+          t._assign(q,wide_cells);
+          t.sign_= sign_==y.sign_ ? PLUS : MINUS;
+          t._round(rest);
+          return *this=t;
+     }
+     ///Remainder of the quotient truncated to an integer; it has the sign of the dividend
+     BigFixed& operator%=(const BigFixed& y) {
+          _divmod(*this,y,NULL,this);
+          return *this;
+     }
+     ///Sets q to x/y truncated to an integer and r to x-q*y, doing the division only once
+     friend void divmod(const BigFixed& x, const BigFixed& y, BigFixed& q, BigFixed& r) {
+          _divmod(x,y,&q,&r);
+     }
+///A non-assigning binary operator identified by *X*
+#define BFIX_BINOP_(X) friend BigFixed operator X (BigFixed x, const BigFixed& y) { x X##= y; return x; }
+     BFIX_BINOP_(*)
+     BFIX_BINOP_(/)
+     BFIX_BINOP_(%)
+#undef BFIX_BINOP_
+
+     ///Reads a number from the characters in [first,last), returning where it ends (first if there is no number, which reads as zero)
+     const char* read(const char* first, const char* last);
+     ///An upper bound on the number of characters to_chars() writes
+     size_t chars_size() const {
+          return chars_max;
+     }
+     ///Writes the number to [first,last) as BigN does, without the zeros at the end of the fraction, returning the end of what was written (0 if it doesn't fit; chars_size() characters always do)
+     char* to_chars(char* first, char* last) const;
+     friend ostream& operator<<(ostream& os, const BigFixed& x) {
+          char buf[chars_max];
+          return os.write(buf,x.to_chars(buf,buf+sizeof buf)-buf);
+     }
+     ///Reads the characters of a number, as BigN does
+     friend istream& operator>>(istream& is, BigFixed& x) {
+          string buf;
+          istream::sentry ok(is);
+          if(ok) {
+               streambuf* sb=is.rdbuf();
+               bool dp=false;
+               for(int c=sb->sgetc(); ; c=sb->snextc()) {
+                    if(c==EOF) {
+                         is.setstate(ios::eofbit);
+                         break;
+                    }
+                    if((c>='0' && c<='9') || ((c=='-' || c=='+') && buf.empty()))
+                         buf+=char(c);
+                    else if(c=='.' && !dp) {
+                         buf+=char(c);
+                         dp=true;
+                    } else
+                         break;
+               }
+          }
+          if(x.read(buf.data(),buf.data()+buf.size())==buf.data())
+               is.setstate(ios::failbit);
+          return is;
+     }
+     friend string to_string(const BigFixed& x) {
+          char buf[chars_max];
+          return string(buf,x.to_chars(buf,buf+sizeof buf));
+     }
+};
+
+template<unsigned N, unsigned Scale, typename S>
+round_mode BigFixed<N,Scale,S>::rounding=ROUND_DOWN;
+
+/**\brief Divides the un cells of u by the ncells cells of v (not zero), writing the un cells of the quotient to q and the remainder to r.
+Divisors of a single cell are divided by BigN::_cells_div1(), longer ones by BigN::_div_knuth_scratch() on cells on the stack.
+*/
+template<unsigned N, unsigned Scale, typename S>
+void BigFixed<N,Scale,S>::_div_cells(const S* u, long un, const S* v, S* q, Cells& r)
+{
+     long vz=0, uz=0;
+     for(; !v[vz]; ++vz)
+          ;;
+     for(; uz<un && !u[uz]; ++uz)
+          ;;
+     long vn=ncells-vz;
+     fill(q,q+un,S(0));
+     r=Cells();
+     if(un-uz<vn)
+          copy(u+uz,u+un,r.end()-(un-uz));
+     else if(vn==1) {
+          copy(u,u+un,q);
+          r[ncells-1]=Kernels::_cells_div1(q,un,v[ncells-1]);
+     } else {
+          S nu[wide_cells+1], nv[ncells];
+          nu[0]=0;
+          copy(u+uz,u+un,nu+1);
+          copy(v+vz,v+ncells,nv);
+          Kernels::_div_knuth_scratch(nu,un-uz,nv,vn,q+uz+vn-1,r.end()-vn);
+     }
+}
+/**\brief Divides x by y, truncating the quotient to an integer.
+Both are multiples of 10^-Scale, so the remainder is exact.
+\param [out] q The quotient, unless NULL; throws exOverflow if it doesn't fit (then before anything is written)
+\param [out] r The remainder, which has the sign of x, unless NULL. Either may alias x or y.
+*/
+template<unsigned N, unsigned Scale, typename S>
+void BigFixed<N,Scale,S>::_divmod(const BigFixed& x, const BigFixed& y, BigFixed* q, BigFixed* r)
+{
+     if(!y)
+          throw exDivByZero();
+     esign qsign= x.sign_==y.sign_ ? PLUS : MINUS, rsign=x.sign_;
+     S qc[ncells], u[wide_cells];
+     Cells rc;
+     _div_cells(x.v_.data(),ncells,y.v_.data(),qc,rc);
+     if(q) {
+          _upscale(qc,ncells,u);
+          q->_assign(u,wide_cells);
+          q->sign_=qsign;
+          if(q->_is_zero())
+               q->sign_=PLUS;
+     }
+     if(r) {
+          r->v_=rc;
+          r->sign_=rsign;
+          if(r->_is_zero())
+               r->sign_=PLUS;
+     }
+}
+template<unsigned N, unsigned Scale, typename S>
+u64 BigFixed<N,Scale,S>::_int_part_abs() const
+{
+     Cells c=v_;
+     long n=ncells-scale_cells;
+     Kernels::_cells_div1(c.data(),n,S(scale_mul));
+     u64 m=0;
+     for(long i=0; i<n; ++i) {
+          if(m>(numeric_limits<u64>::max()-c[i])/cshift)
+               return numeric_limits<u64>::max();
+          m=m*cshift+c[i];
+     }
+     return m;
+}
+template<unsigned N, unsigned Scale, typename S>
+const char* BigFixed<N,Scale,S>::read(const char* first, const char* last)
+{
+     const char* p=first;
+     bool neg=false;
+     if(p!=last && (*p=='-' || *p=='+'))
+          neg= *p++=='-';
+     const char* ibeg=p, *iend=skip_digits(p,last);
+     const char* fbeg=iend, *fend=iend;
+     if(iend!=last && *iend=='.')
+          fend=skip_digits(fbeg=iend+1,last);
+     if(ibeg==iend && fbeg==fend) {
+          *this=BigFixed();
+          return first;
+     }
+     while(ibeg!=iend && *ibeg=='0')
+          ++ibeg;
+     if(iend-ibeg>long(N-Scale))
+          throw exOverflow();
+
+     //The digits of the magnitude times 10^Scale, filling whole cells; they go to t, so that *this stays as it is if rounding them overflows
+     BigFixed t;
+     char d[ncells*cshift10d];
+     char* point=d+sizeof d-Scale;
+     long nfrac=min(long(fend-fbeg),long(Scale));
+     fill(d,d+sizeof d,'0');
+     copy(ibeg,iend,point-(iend-ibeg));
+     copy(fbeg,fbeg+nfrac,point);
+     for(long i=0; i<ncells; ++i)
+          t.v_[i]=digits_value<S>(d+i*cshift10d,cshift10d);
+     t.sign_= neg ? MINUS : PLUS;
+
+     int rest=0;
+     if(fend-fbeg>long(Scale)) {
+          const char* c=fbeg+Scale;
+          bool sticky=false;
+          for(const char* q=c+1; q!=fend && !sticky; ++q)
+               sticky= *q!='0';
+          rest=cut_rest(short(*c-'0'),sticky);
+     }
+     t._round(rest);
+     *this=t;
+     return fend;
+}
+template<unsigned N, unsigned Scale, typename S>
+char* BigFixed<N,Scale,S>::to_chars(char* first, char* last) const
+{
+     char d[ncells*cshift10d];
+     for(long i=0; i<ncells; ++i)
+          fixed_digits(d+i*cshift10d,v_[i],cshift10d);
+     const char* b=d, *point=d+sizeof d-Scale, *end=d+sizeof d;
+     while(b!=point && *b=='0')
+          ++b;
+     while(end!=point && end[-1]=='0')
+          --end;
+     if(last-first < (b==end ? 1 : (sign_==MINUS)+(point-b)+(end!=point ? 1+(end-point) : 0)))
+          return 0;
+     char* p=first;
+     if(b==end) {
+          *p++='0';
+          return p;
+     }
+     if(sign_==MINUS)
+          *p++='-';
+     p=copy(b,point,p);
+     if(end!=point) {
+          *p++='.';
+          p=copy(point,end,p);
+     }
+     return p;
+}
+
+}//namespace BigNum
+#endif /* BIGFIXED_HPP_ */
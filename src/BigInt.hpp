@@ -0,0 +1,582 @@
+#ifndef BIGINT_HPP_
+#define BIGINT_HPP_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <cctype>
+#include <cstring>
+#include <sstream>
+#include <type_traits>
+#include <stdexcept>
+
+#include "bign_supplemental.hpp"
+#include "BigN.hpp"
+#include "bign_ntt.hpp"
+
+#ifndef BIGINT_CONV_THRESHOLD
+///Length (in limbs, or in 19-digit chunks) from which on BigInt converts to and from decimal by divide and conquer. Override with -DBIGINT_CONV_THRESHOLD=n
+#define BIGINT_CONV_THRESHOLD 30
+#endif
+
+/**
+ * \file
+ * \brief The BigInt class—an arbitrary precision integer stored in binary.
+ */
+
+namespace BigNum {
+using namespace std;
+
+#ifdef __SIZEOF_INT128__
+/**\brief An Arbitrary Precision Integer with Binary Limbs
+Stores the magnitude in 64-bit limbs, so that carries are native instead of divisions by BigN::cshift. Products and quotients of limbs are computed in u128.
+Decimal digits are only dealt with on input and output, by divide and conquer: parsing multiplies the halves by powers of 10^19 and printing evaluates the halves in a BigN, multiplying by powers of 2^64, so both take as long as a few of the largest multiplications.
+Division truncates toward zero, like it does on native integers.
+\note Requires a compiler with unsigned __int128.
+*/
+class BigInt {
+public:
+     enum esign { PLUS=0, MINUS=1 };
+     enum {
+          kmul_threshold=KARATSUBA_THRESHOLD,	///<Shorter operands are multiplied by long multiplication, longer ones by Karatsuba
+          conv_threshold=BIGINT_CONV_THRESHOLD,	///<Shorter numbers are converted from and to decimal digit by digit
+          ntt_threshold=NTT_THRESHOLD,		///<Operands at least this long are multiplied by number-theoretic transforms
+          chunk10d=19				///<Decimal digits that are read into a limb at once
+     };
+     typedef BigN<u64> Decimal;
+     typedef Decimal::exDivByZero exDivByZero;
+private:
+     ///Limbs of the magnitude, least significant first, without zero limbs at the end (zero has no limbs)
+     vector<u64> v_;
+     esign sign_;
+
+     void _trim() {
+          while(!v_.empty() && !v_.back())
+               v_.pop_back();
+          if(v_.empty())
+               sign_=PLUS;
+     }
+     template<typename T>
+     void _read_in_from_a_number(T x, true_type) {
+          sign_= x<0 ? MINUS : PLUS;
+          u64 ux= x<0 ? u64(0)-u64(x) : u64(x);
+          v_.assign(ux ? 1 : 0,ux);
+     }
+     ///Floating point numbers are truncated
+     template<typename T>
+     void _read_in_from_a_number(T x, false_type) {
+          sign_= x<0 ? MINUS : PLUS;
+          x=floor(fabs(x));
+          const T limb=T(numeric_limits<u64>::max())+1;
+          v_.clear();
+          for(; x>=1; x=floor(x/limb))
+               v_.push_back(u64(fmod(x,limb)));
+          _trim();
+     }
+     void _read_in_from_decimal(const char* s, long len);
+     void _iaddsub(const BigInt& y, bool sub);
+     static void _divmod(const BigInt& x, const BigInt& y, BigInt* q, BigInt* r);
+     ostream& _print(ostream& os) const;
+
+     /**\name Limb Kernels
+     Work on raw limbs, least significant first.
+     @{*/
+     static int _limbs_cmp(const u64* a, long an, const u64* b, long bn);
+     static u64 _limbs_add(u64* r, long rn, const u64* x, long xn);
+     static u64 _limbs_sub(u64* r, long rn, const u64* x, long xn);
+     static void _limbs_muladd1(vector<u64>& r, u64 m, u64 a);
+     static u64 _limbs_div1(u64* r, long rn, u64 d);
+     static void _mul_limbs(const u64* a, long an, const u64* b, long bn, u64* r);
+     static void _mul_basecase(const u64* a, long an, const u64* b, long bn, u64* r);
+     static void _mul_karatsuba(const u64* a, long an, const u64* b, long bn, u64* r);
+     static bool _mul_ntt(const u64* a, long an, const u64* b, long bn, u64* r);
+     static void _div_knuth(const u64* u, long un, const u64* v, long vn, u64* q, u64* r);
+     static void _from_decimal(const char* s, long len, vector<vector<u64> >& pows, vector<u64>& r);
+     static Decimal _to_decimal(const u64* x, long n, vector<Decimal>& pows);
+     ///@}
+public:
+     BigInt() : sign_(PLUS) {}
+     ///Construct from native integers and floating point numbers; the latter are truncated
+     template<typename T>
+     BigInt(T x) {
+          _read_in_from_a_number(x,integral_constant<bool,numeric_limits<T>::is_integer>());
+     }
+     ///Read in from a boolean (true==1, false==0)
+     BigInt(bool b) {
+          _read_in_from_a_number(int(b),true_type());
+     }
+     ///Read a decimal integer
+     BigInt(const char* istr) : sign_(PLUS) {
+          bool neg= *istr=='-';
+          if(*istr=='-' || *istr=='+')
+               ++istr;
+          _read_in_from_decimal(istr,strlen(istr));
+          if(neg && !v_.empty())
+               sign_=MINUS;
+     }
+     BigInt(istream& is) : sign_(PLUS) {
+          is>>*this;
+     }
+     template<typename T>
+     BigInt& operator=(T x) {
+          return *this=BigInt(x);
+     }
+
+     explicit operator bool() const {
+          return !v_.empty();
+     }
+     ///Converts to a native integer, saturated at the limits of its type
+     template<typename T, typename=typename enable_if<is_integral<T>::value && !is_same<T,bool>::value>::type>
+     explicit operator T() const {
+          u64 m= v_.size()>1 ? ~u64(0) : v_.empty() ? 0 : v_[0], hi=u64(numeric_limits<T>::max());
+          if(sign_==PLUS)
+               return m>hi ? numeric_limits<T>::max() : T(m);
+          if(!numeric_limits<T>::is_signed)
+               return 0;
+          return m>hi ? numeric_limits<T>::min() : T(-T(m));
+     }
+
+     int compare(const BigInt& y) const {
+          if(sign_!=y.sign_)
+               return sign_==MINUS ? -1 : 1;
+          int c=_limbs_cmp(v_.data(),v_.size(),y.v_.data(),y.v_.size());
+          return sign_==MINUS ? -c : c;
+     }
+///Macro to write the comparison operators
+#define BINT_CMP_(X) friend bool operator X (const BigInt& x, const BigInt& y) { return x.compare(y) X 0; }
+     BINT_CMP_(==)
+     BINT_CMP_(!=)
+     BINT_CMP_(<)
+     BINT_CMP_(>)
+     BINT_CMP_(<=)
+     BINT_CMP_(>=)
+#undef BINT_CMP_
+
+     BigInt& operator-() {
+          if(!v_.empty())
+               sign_= sign_==PLUS ? MINUS : PLUS;
+          return *this;
+     }
+     BigInt& operator+() {
+          return *this;
+     }
+     BigInt& operator+=(const BigInt& y) {
+          if(this==&y)
+               return *this+=BigInt(y);
+          _iaddsub(y,sign_!=y.sign_);
+          return *this;
+     }
+     BigInt& operator-=(const BigInt& y) {
+          if(this==&y)
+               return *this=0;
+          _iaddsub(y,sign_==y.sign_);
+          return *this;
+     }
+     BigInt& operator++() {
+          return *this+=1;
+     }
+     BigInt& operator--() {
+          return *this-=1;
+     }
+     BigInt& operator*=(const BigInt& y) {
+          if(v_.empty() || y.v_.empty())
+               return *this=0;
+          vector<u64> r(v_.size()+y.v_.size());
+          _mul_limbs(v_.data(),v_.size(),y.v_.data(),y.v_.size(),r.data());
+          v_.swap(r);
+          sign_= sign_==y.sign_ ? PLUS : MINUS;
+          _trim();
+          return *this;
+     }
+     ///Quotient truncated toward zero. Throws exDivByZero if y is zero.
+     BigInt& operator/=(const BigInt& y) {
+          _divmod(*this,y,this,NULL);
+          return *this;
+     }
+     ///Remainder of the truncated division; it has the sign of the dividend
+     BigInt& operator%=(const BigInt& y) {
+          _divmod(*this,y,NULL,this);
+          return *this;
+     }
+     ///Sets q to x/y and r to x%y, doing the division only once
+     friend void divmod(const BigInt& x, const BigInt& y, BigInt& q, BigInt& r) {
+          _divmod(x,y,&q,&r);
+     }
+///A non-assigning binary operator identified by *X*
+#define BINT_BINOP_(X) friend BigInt operator X (BigInt x, const BigInt& y) { x X##= y; return x; }
+     BINT_BINOP_(+)
+     BINT_BINOP_(-)
+     BINT_BINOP_(*)
+     BINT_BINOP_(/)
+     BINT_BINOP_(%)
+#undef BINT_BINOP_
+
+     friend ostream& operator<<(ostream& os, const BigInt& x) {
+          return x._print(os);
+     }
+     ///Reads an optionally signed sequence of decimal digits; sets the failbit if there are none
+     friend istream& operator>>(istream& is, BigInt& x);
+     friend string to_string(const BigInt& x) {
+          stringstream ss;
+          ss<<x;
+          return ss.str();
+     }
+};
+
+inline istream& operator>>(istream& is, BigInt& x)
+{
+     if(is.flags() & ios::skipws)
+          is>>ws;
+     bool neg=false;
+     if(is.peek()=='-' || is.peek()=='+')
+          neg= is.get()=='-';
+     string digits;
+     while(isdigit(is.peek()))
+          digits+=char(is.get());
+     if(digits.empty()) {
+          is.setstate(ios::failbit);
+          return is;
+     }
+     x._read_in_from_decimal(digits.data(),digits.size());
+     if(neg && !x.v_.empty())
+          x.sign_=BigInt::MINUS;
+     return is;
+}
+
+///Adds the magnitude of y to that of *this, or subtracts it if sub is true, in place; the sign flips if a greater magnitude is subtracted
+inline void BigInt::_iaddsub(const BigInt& y, bool sub)
+{
+     long yn=y.v_.size();
+     if(!sub) {
+          if((long)v_.size()<yn)
+               v_.resize(yn,0);
+          if(_limbs_add(v_.data(),v_.size(),y.v_.data(),yn))
+               v_.push_back(1);
+          return;
+     }
+     if(_limbs_cmp(v_.data(),v_.size(),y.v_.data(),yn)>=0)
+          _limbs_sub(v_.data(),v_.size(),y.v_.data(),yn);
+     else {
+          vector<u64> r(y.v_);
+          _limbs_sub(r.data(),yn,v_.data(),v_.size());
+          v_.swap(r);
+          sign_= sign_==PLUS ? MINUS : PLUS;
+     }
+     _trim();
+}
+/**\brief Divides x by y, truncating toward zero.
+\param [out] q The quotient, unless NULL
+\param [out] r The remainder, which has the sign of x, unless NULL. Either may alias x or y, but not each other.
+*/
+inline void BigInt::_divmod(const BigInt& x, const BigInt& y, BigInt* q, BigInt* r)
+{
+     if(y.v_.empty())
+          throw exDivByZero();
+     esign qsign= x.sign_==y.sign_ ? PLUS : MINUS, rsign=x.sign_;
+     long un=x.v_.size(), vn=y.v_.size();
+     vector<u64> qv, rv;
+     if(_limbs_cmp(x.v_.data(),un,y.v_.data(),vn)<0)
+          rv=x.v_;
+     else if(vn==1) {
+          qv=x.v_;
+          rv.assign(1,_limbs_div1(qv.data(),un,y.v_[0]));
+     } else {
+          qv.resize(un-vn+1);
+          rv.resize(vn);
+          _div_knuth(x.v_.data(),un,y.v_.data(),vn,qv.data(),rv.data());
+     }
+     if(r) {
+          r->v_.swap(rv);
+          r->sign_=rsign;
+          r->_trim();
+     }
+     if(q) {
+          q->v_.swap(qv);
+          q->sign_=qsign;
+          q->_trim();
+     }
+}
+///Compares raw limb arrays without zero limbs at the end
+///\return a value >0 if a>b, 0 if a==b, and a value <0 if a<b
+inline int BigInt::_limbs_cmp(const u64* a, long an, const u64* b, long bn)
+{
+     if(an!=bn)
+          return an>bn ? 1 : -1;
+     for(long i=an-1; i>=0; --i)
+          if(a[i]!=b[i])
+               return a[i]>b[i] ? 1 : -1;
+     return 0;
+}
+///Adds x to r (xn<=rn)
+///\return the carry out of r's last limb
+inline u64 BigInt::_limbs_add(u64* r, long rn, const u64* x, long xn)
+{
+     u64 carry=0;
+     long i=0;
+     for(; i<xn; ++i) {
+          u128 t=u128(r[i])+x[i]+carry;
+          r[i]=u64(t);
+          carry=u64(t>>64);
+     }
+     for(; carry && i<rn; ++i)
+          carry= ++r[i]==0;
+     return carry;
+}
+///Subtracts x from r (xn<=rn)
+///\return the borrow out of r's last limb (nonzero if x was greater than r)
+inline u64 BigInt::_limbs_sub(u64* r, long rn, const u64* x, long xn)
+{
+     u64 borrow=0;
+     long i=0;
+     for(; i<xn; ++i) {
+          u128 t=u128(r[i])-x[i]-borrow;
+          r[i]=u64(t);
+          borrow=u64(t>>64)&1;
+     }
+     for(; borrow && i<rn; ++i)
+          borrow= r[i]--==0;
+     return borrow;
+}
+///Sets r to r*m+a, growing it if needed
+inline void BigInt::_limbs_muladd1(vector<u64>& r, u64 m, u64 a)
+{
+     u64 carry=a;
+     for(size_t i=0; i<r.size(); ++i) {
+          u128 t=u128(r[i])*m+carry;
+          r[i]=u64(t);
+          carry=u64(t>>64);
+     }
+     if(carry)
+          r.push_back(carry);
+}
+///Divides r by a single limb d in place
+///\return the remainder
+inline u64 BigInt::_limbs_div1(u64* r, long rn, u64 d)
+{
+     u128 rem=0;
+     for(long i=rn-1; i>=0; --i) {
+          u128 t=(rem<<64)|r[i];
+          r[i]=u64(t/d);
+          rem=t%d;
+     }
+     return u64(rem);
+}
+///Multiplies two raw limb arrays, writing all an+bn limbs of the product into r (which must not overlap with a or b)
+inline void BigInt::_mul_limbs(const u64* a, long an, const u64* b, long bn, u64* r)
+{
+     if(an<bn) {
+          swap(a,b);
+          swap(an,bn);
+     }
+     if(bn<kmul_threshold)
+          _mul_basecase(a,an,b,bn,r);
+     else if(bn>=ntt_threshold && _mul_ntt(a,an,b,bn,r))
+          return;
+     else if(an>=2*bn) {
+          //Unbalanced: pieces of a as long as b
+          fill(r,r+an+bn,u64(0));
+          vector<u64> t(2*bn);
+          for(long lo=0; lo<an; lo+=bn) {
+               long len=min(bn,an-lo);
+               _mul_limbs(a+lo,len,b,bn,t.data());
+               _limbs_add(r+lo,an+bn-lo,t.data(),len+bn);
+          }
+     } else
+          _mul_karatsuba(a,an,b,bn,r);
+}
+///Long multiplication of raw limb arrays
+inline void BigInt::_mul_basecase(const u64* a, long an, const u64* b, long bn, u64* r)
+{
+     fill(r,r+an+bn,u64(0));
+     for(long i=0; i<bn; ++i) {
+          u64 carry=0;
+          for(long j=0; j<an; ++j) {
+               u128 t=u128(a[j])*b[i]+r[i+j]+carry;
+               r[i+j]=u64(t);
+               carry=u64(t>>64);
+          }
+          r[i+an]=carry;
+     }
+}
+///Karatsuba multiplication of raw limb arrays (an>=bn>an/2); see BigN::_mul_karatsuba()
+inline void BigInt::_mul_karatsuba(const u64* a, long an, const u64* b, long bn, u64* r)
+{
+     long m=an/2;
+     long rn=an+bn;
+     //z0 fills the first 2m limbs of r and z2 the rest
+     _mul_limbs(a,m,b,m,r);
+     _mul_limbs(a+m,an-m,b+m,bn-m,r+2*m);
+
+     //b's high half can be a limb longer than its low half (an odd, bn-m==m+1), and the sum another one
+     vector<u64> sa(a+m,a+an), sb(max(bn-m,m)+1,0);
+     sa.push_back(0);
+     copy(b,b+m,sb.begin());
+     _limbs_add(sa.data(),sa.size(),a,m);
+     _limbs_add(sb.data(),sb.size(),b+m,bn-m);
+
+     vector<u64> z1(sa.size()+sb.size());
+     _mul_limbs(sa.data(),sa.size(),sb.data(),sb.size(),z1.data());
+     _limbs_sub(z1.data(),z1.size(),r,2*m);
+     _limbs_sub(z1.data(),z1.size(),r+2*m,rn-2*m);
+     long z1n=z1.size();
+     while(z1n>rn-m)
+          --z1n;
+     _limbs_add(r+m,rn-m,z1.data(),z1n);
+}
+///Multiplies raw limb arrays by means of number-theoretic transforms on 16-bit digits (see ntt_multiply()); squares if a and b are the same
+///\return false if they are too long for the transforms (r is untouched then)
+inline bool BigInt::_mul_ntt(const u64* a, long an, const u64* b, long bn, u64* r)
+{
+     vector<u32> ca(4*an), cb, cr;
+     for(long i=0; i<4*an; ++i)
+          ca[i]=u32(a[i/4]>>(16*(i%4)))&0xffff;
+     if(a!=b || an!=bn) {
+          cb.resize(4*bn);
+          for(long i=0; i<4*bn; ++i)
+               cb[i]=u32(b[i/4]>>(16*(i%4)))&0xffff;
+     }
+     if(!ntt_multiply(ca,cb.empty() ? ca : cb,1<<16,cr))
+          return false;
+     for(long i=0; i<an+bn; ++i)
+          r[i]=u64(cr[4*i])|u64(cr[4*i+1])<<16|u64(cr[4*i+2])<<32|u64(cr[4*i+3])<<48;
+     return true;
+}
+/**\brief Integer division of raw limbs by Knuth's algorithm D (The Art of Computer Programming, vol. 2, 4.3.1).
+
+Divides u (un limbs) by v (vn>=2 limbs, v[vn-1]!=0, un>=vn), writing the un-vn+1 limbs of the quotient into q and the vn limbs of the remainder into r.
+Both are first shifted left until the top bit of the divisor is set.
+*/
+inline void BigInt::_div_knuth(const u64* u, long un, const u64* v, long vn, u64* q, u64* r)
+{
+     int s=__builtin_clzll(v[vn-1]);
+     vector<u64> nu(un+1), nv(vn);
+     for(long i=vn-1; i>0; --i)
+          nv[i]= s ? v[i]<<s | v[i-1]>>(64-s) : v[i];
+     nv[0]=v[0]<<s;
+     nu[un]= s ? u[un-1]>>(64-s) : 0;
+     for(long i=un-1; i>0; --i)
+          nu[i]= s ? u[i]<<s | u[i-1]>>(64-s) : u[i];
+     nu[0]=u[0]<<s;
+
+     const u128 b=u128(1)<<64;
+     for(long j=un-vn; j>=0; --j) {
+          u128 num=(u128(nu[j+vn])<<64)|nu[j+vn-1];
+          u128 qhat=num/nv[vn-1], rhat=num%nv[vn-1];
+          while(qhat>=b || qhat*nv[vn-2]>((rhat<<64)|nu[j+vn-2])) {
+               --qhat;
+               rhat+=nv[vn-1];
+               if(rhat>=b)
+                    break;
+          }
+          //nu[j..j+vn]-=qhat*nv
+          u64 carry=0, borrow=0;
+          for(long i=0; i<vn; ++i) {
+               u128 p=qhat*nv[i]+carry;
+               carry=u64(p>>64);
+               u128 t=u128(nu[i+j])-u64(p)-borrow;
+               nu[i+j]=u64(t);
+               borrow=u64(t>>64)&1;
+          }
+          u128 t=u128(nu[j+vn])-carry-borrow;
+          nu[j+vn]=u64(t);
+          if(u64(t>>64)&1) {
+               //qhat was one too high; add nv back (the carry out cancels the wrap-around)
+               --qhat;
+               nu[j+vn]+=_limbs_add(&nu[j],vn,nv.data(),vn);
+          }
+          q[j]=u64(qhat);
+     }
+     for(long i=0; i<vn; ++i)
+          r[i]= s ? nu[i]>>s | nu[i+1]<<(64-s) : nu[i];
+}
+/**\brief Converts len decimal digits into limbs.
+Short strings are read 19 digits at a time; longer ones are split so that the lower part is 19*2^j digits long, and the upper part's value is multiplied by 10^(19*2^j), which is pows[j].
+*/
+inline void BigInt::_from_decimal(const char* s, long len, vector<vector<u64> >& pows, vector<u64>& r)
+{
+     if(len<=conv_threshold*chunk10d) {
+          r.clear();
+          for(long i=0, k=len%chunk10d ? len%chunk10d : long(chunk10d); i<len; i+=k, k=chunk10d) {
+               u64 c=0;
+               for(long j=i; j<i+k; ++j)
+                    c=c*10+(s[j]-'0');
+               _limbs_muladd1(r,pten[k],c);
+          }
+          while(!r.empty() && !r.back())
+               r.pop_back();
+          return;
+     }
+     long j=0;
+     while(long(chunk10d)<<(j+1)<len)
+          ++j;
+     long l=long(chunk10d)<<j;
+     while((long)pows.size()<=j) {
+          const vector<u64>& p=pows.back();
+          vector<u64> sq(2*p.size());
+          _mul_limbs(p.data(),p.size(),p.data(),p.size(),sq.data());
+          while(!sq.back())
+               sq.pop_back();
+          pows.push_back(sq);
+     }
+     vector<u64> hi, lo;
+     _from_decimal(s,len-l,pows,hi);
+     _from_decimal(s+len-l,l,pows,lo);
+     const vector<u64>& p=pows[j];
+     r.assign(hi.size()+p.size()+1,0);
+     if(!hi.empty())
+          _mul_limbs(hi.data(),hi.size(),p.data(),p.size(),r.data());
+     _limbs_add(r.data(),r.size(),lo.data(),lo.size());
+     while(!r.empty() && !r.back())
+          r.pop_back();
+}
+inline void BigInt::_read_in_from_decimal(const char* s, long len)
+{
+     vector<vector<u64> > pows(1,vector<u64>(1,pten[chunk10d]));
+     _from_decimal(s,len,pows,v_);
+     sign_=PLUS;
+}
+/**\brief Converts n limbs into a (decimal) BigN.
+Short numbers are evaluated limb by limb; longer ones are split into the lower 2^j limbs and the upper ones, whose value is multiplied by 2^(64*2^j), which is pows[j].
+*/
+inline BigInt::Decimal BigInt::_to_decimal(const u64* x, long n, vector<Decimal>& pows)
+{
+     while(n && !x[n-1])
+          --n;
+     if(n<=conv_threshold) {
+          Decimal r=0;
+          for(long i=n-1; i>=0; --i) {
+               r*=pows[0];
+               r+=Decimal(x[i]);
+          }
+          return r;
+     }
+     long j=0;
+     while((2L<<j)<n)
+          ++j;
+     while((long)pows.size()<=j) {
+          Decimal p=pows.back();
+          pows.push_back(move(p.square()));
+     }
+     long h=1L<<j;
+     Decimal r=_to_decimal(x+h,n-h,pows);
+     r*=pows[j];
+     r+=_to_decimal(x,h,pows);
+     return r;
+}
+inline ostream& BigInt::_print(ostream& os) const
+{
+     if(v_.empty())
+          return os<<'0';
+     if(sign_==MINUS)
+          os<<'-';
+     if(v_.size()==1)
+          return os<<v_[0];
+     vector<Decimal> pows(1,Decimal("18446744073709551616"));
+     return os<<_to_decimal(v_.data(),v_.size(),pows);
+}
+#endif
+
+}//namespace BigNum
+#endif /* BIGINT_HPP_ */
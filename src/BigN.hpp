@@ -9,34 +9,124 @@
 #include <cstring>
 #include <limits>
 #include <vector>
+#include <iterator>
 #include <cmath>
 #include <stdexcept>
+#include <type_traits>
 
 
 #include "bign_supplemental.hpp"
+#include "bign_cells.hpp"
+
+#ifndef KARATSUBA_THRESHOLD
+///Operand length (in cells) from which on BigN multiplication recurses with Karatsuba instead of doing long multiplication. Override with -DKARATSUBA_THRESHOLD=n
+#define KARATSUBA_THRESHOLD 40
+#endif
+#ifndef TOOM3_THRESHOLD
+///Operand length (in cells) from which on BigN multiplication recurses with Toom-Cook 3-way instead of Karatsuba. Override with -DTOOM3_THRESHOLD=n
+#define TOOM3_THRESHOLD 150
+#endif
+#ifndef NTT_THRESHOLD
+///Operand length (in cells) from which on BigN multiplication is done by number-theoretic transforms. Override with -DNTT_THRESHOLD=n
+#define NTT_THRESHOLD 800
+#endif
+#ifndef DIV_NEWTON_THRESHOLD
+///Divisor and quotient length (in cells) from which on BigN division uses a Newton reciprocal instead of Knuth's long division. Override with -DDIV_NEWTON_THRESHOLD=n
+#define DIV_NEWTON_THRESHOLD 150
+#endif
 
 namespace BigNum {
 using namespace std;
 
+///\brief Scans the characters of a numeric literal in constant expressions (see BigNLiteral).
+struct LiteralScan {
+     ///Whether the characters from s[i] to s[n-1] are decimal digits with at most one decimal point (*dots* have come before them)
+     static constexpr bool valid(const char* s, long n, long i=0, int dots=0) {
+          return i==n ? dots<=1 : s[i]=='.' ? valid(s,n,i+1,dots+1) : s[i]>='0' && s[i]<='9' && valid(s,n,i+1,dots);
+     }
+     ///The index of the decimal point, or n if there is none
+     static constexpr long point(const char* s, long n, long i=0) {
+          return i==n || s[i]=='.' ? i : point(s,n,i+1);
+     }
+     ///The index of the first digit before index p that isn't zero, or p
+     static constexpr long lead(const char* s, long p, long i=0) {
+          return i<p && s[i]=='0' ? lead(s,p,i+1) : i;
+     }
+     ///Digit k of the number whose nint digits before the point start at s[lead], and whose digits are ndigits in all (zeros beyond them)
+     static constexpr int digit(const char* s, long lead, long nint, long ndigits, long k) {
+          return k<ndigits ? s[lead+k+(k>=nint)]-'0' : 0;
+     }
+     ///The value of n digits from digit k on, after *acc*
+     static constexpr u64 value(const char* s, long lead, long nint, long ndigits, long k, int n, u64 acc=0) {
+          return n ? value(s,lead,nint,ndigits,k+1,n-1,acc*10+digit(s,lead,nint,ndigits,k)) : acc;
+     }
+};
+///\brief The cells of the literal L; see BigNLiteral.
+template<typename L, typename S, typename I> struct LiteralCells;
+template<typename L, typename S, long... I> struct LiteralCells<L,S,Indices<I...> > {
+     static constexpr S v[sizeof...(I)]= {S(LiteralScan::value(L::s,L::lead,L::nint,L::ndigits,I*L::cshift10d,L::cshift10d))...};
+};
+template<typename L, typename S, long... I> constexpr S LiteralCells<L,S,Indices<I...> >::v[sizeof...(I)];
+/**\brief The number that the characters C... of a literal write, as BigN cells of type S, computed at compile time.
+The cells are laid out as BigN::read() lays them out: zeros before the decimal point are skipped, and the last cell is filled up with zeros, which count into the scale.
+\note Literals are scanned recursively, a character at a time, so they can be a few hundred characters long (see the -fconstexpr-depth of GCC).
+*/
+template<typename S, char... C>
+struct BigNLiteral {
+     static constexpr char s[sizeof...(C)]= {C...};
+     static_assert(LiteralScan::valid(s,sizeof...(C)), "A BigN literal can only have decimal digits and a decimal point.");
+     enum {
+          cshift10d=CellDigits<S>::n,
+          len=sizeof...(C),
+          point=LiteralScan::point(s,len),
+          lead=LiteralScan::lead(s,point),
+          nint=point-lead,
+          nfrac= point<len ? len-point-1 : 0,
+          ndigits=nint+nfrac,
+          ncells= ndigits ? (ndigits+cshift10d-1)/cshift10d : 1,
+          scale= ndigits ? nfrac+ncells*cshift10d-ndigits : 0
+     };
+     static const S* cells() {
+          return LiteralCells<BigNLiteral,S,typename MakeIndices<ncells>::type>::v;
+     }
+};
+template<typename S, char... C> constexpr char BigNLiteral<S,C...>::s[sizeof...(C)];
+
 /**\brief An Arbitrary Precision Number
- \tparam type of elementary storage units (cells)
+ \tparam S type of elementary storage units (cells)
+ \tparam A allocator of the cells (e.g. an ArenaAllocator)
  \sa \ref about
   */
-template<typename S=STYPE>
+template<typename S=STYPE, typename A=allocator<S> >
 class BigN {
      static_assert( numeric_limits<S>::is_integer && !(numeric_limits<S>::is_signed), "Must use an unsigned integer storage type." );
 
 public:
      ///Some class-wide invariants
      enum {
-          cshift10d = IntLog<10,(Pow<2,sizeof(S)*8/2>::n)-1>::n , 	///<The capacity of a cell in decimal digits (only the lower half is considered)
-          cshift=Pow<10,cshift10d>::n 					///<A power of ten multiplying by which is tantamount to shifting by a whole cell to the left
+          cshift10d = CellDigits<S>::n , 	///<The capacity of a cell in decimal digits (only the lower half is considered, unless -DDENSE_U64)
+          cshift=Pow(10,cshift10d), 					///<A power of ten multiplying by which is tantamount to shifting by a whole cell to the left
+          kmul_threshold=KARATSUBA_THRESHOLD,			///<Shorter operands are multiplied by long multiplication, longer ones by Karatsuba
+          toom3_threshold=TOOM3_THRESHOLD,			///<Operands at least this long are multiplied by Toom-Cook 3-way
+          ntt_threshold=NTT_THRESHOLD,				///<Operands at least this long are multiplied by number-theoretic transforms
+          ntt_cells= cshift10d<9 ? 9/cshift10d : 1,		///<Number of cells packed into a single coefficient of a number-theoretic transform
+          ntt_split= cshift10d>9 ? cshift10d/9 : 1,		///<Number of coefficients a single cell is split into (dense cells)
+          ntt_base=Pow(10,cshift10d>9 ? 9 : ntt_cells*cshift10d),		///<The radix of those coefficients
+          div_newton_threshold=DIV_NEWTON_THRESHOLD,		///<Divisors and quotients at least this long are divided with a Newton reciprocal
+          int_cells=(20+cshift10d-1)/cshift10d		///<The most cells a 64-bit integer takes
      };
      enum esign { PLUS=0, MINUS=1 };
      typedef typename HalfType<S>::type HalfST;
+     ///Products of two cells and other double-cell intermediates are computed in this type
+     typedef typename CellWideType<S>::type WideST;
+     enum {
+          column_block=(WideST(1)<<(sizeof(WideST)*8-1))/(WideST(cshift-1)*(cshift-1))	///<How many products of two cells can be summed in a WideST with half of it left for carries
+     };
 private:
-     ///Vector of cells representing the number
-     vector<S> v_;
+     ///Scratch cells of the multiplication and division kernels
+     typedef vector<S,A> Cells;
+     ///Cells representing the number, with headroom at the front for carries
+     CellStore<S,A> v_;
      ///Index of the first nonzero cell
      long beg_; //index of the first nonzero cell
      ///Number of digits behind the decimal point
@@ -44,53 +134,20 @@ private:
      ///Stores the sign of the BigN
      esign sign_;
 
-     ///\brief A reference to a cell.
-     /**Can be used to access (for either reading or writing) individual decimal digits of a cell as if the cell was an array of those digits
-     Only the lower digits of a cell are indexed.
-     \note E.g.: CellR(&v_[beg_])[1] is the second decimal digit of a cell
-     */
-     class CellR {
-     private:
-
-          S* pcell_;
-          S& operator=(const CellR&) {
-               return *pcell_;
-          };
-     public:
-          class Digit;
-          ///Store the pcell pointer to a storage cell
-          CellR(S* pcell) : pcell_(pcell) {}
-
-          ///Return a Digit reference
-          Digit operator[](int coord) const {
-               return Digit(pcell_,coord);
-          }
-          ///Return a class that allows to reference for writing a particular decimal digit in a cell
-          class Digit {
-               S* pcell_;
-               short coord_;
-               typedef typename HalfType<S>::type htype;
-          public:
-               Digit(S* pcell, short coord) : pcell_(pcell),coord_(coord) {}
-               ///Write to the digit, effectively changing the cell as if that particular decimal digit in its decimal representation was changed.
-               Digit& operator=(short n) {
-                    S coeff=pten[numeric_limits<htype>::digits10-1-coord_];
-                    *pcell_+=coeff*(n-short(*this));
-                    return *this;
-               }
-               operator short() const {
-                    return ffront_i_dec<htype>(*pcell_,coord_);
-               }
-          };
-
-     };
      istream& _read_in_from_a_stream(istream& is);
 	 template<typename T>
-	 void _read_in_from_a_number(T x);
+	 void _read_in_from_a_number(T x) {
+		   _read_in_from_a_number(x,integral_constant<bool,numeric_limits<T>::is_integer>());
+	 }
+	 template<typename T>
+	 void _read_in_from_a_number(T x, true_type) {
+		   _read_in_from_an_int(_int_abs(x),x<0);
+	 }
+	 template<typename F>
+	 void _read_in_from_a_number(F x, false_type);
+	 void _read_in_from_an_int(u64 y, bool neg);
 	 void _read_in_from_a_cstring(const char* istr) {
-		   istringstream iss;
-		   iss.rdbuf()->pubsetbuf(const_cast<char*>(istr), strlen(istr));
-		   _read_in_from_a_stream(iss);
+		   read(istr,istr+strlen(istr));
 	 }
 
      ///Convert a character to a number
@@ -120,26 +177,11 @@ private:
      size_t _v_end_zs() const {
           if(scale_<=0)
                return 0;
-          size_t pad=0;
-          long scale=scale_;
-
           //BigNs should be trimmed at the end, so hopefully this one won't run a lot
-          long i=v_.size()-1;
-          for( ; i>=beg_ && v_[i]==0 && scale>=0; --i)
-               scale--;
-          pad=(v_.size()-1-i)*cshift10d;
-
-          //irrelevant final zeros inside the last nonzero cell
-          int j=0;
-          if(scale) {
-               HalfST last=v_[i];
-               for(; last%10==0 && (scale-j)>=0; j++)
-                    last/=10;
-               if(last%10==0)
-                    j--;
-          }
-          return pad+j;
-
+          long end=v_.size()*cshift10d, i=end;
+          for(digit_iterator it(v_.data(),end-1); i>beg_*cshift10d && end-i<scale_ && !*it; --it)
+               --i;
+          return end-i;
      }
 
      ///make sure that beg_ points to the first nonzero cell but don't shift the array; starts at last beg_
@@ -165,10 +207,8 @@ private:
 
           ///Trim Left of digit position pos, either really doing a hard trim (if lazy=false), or just adjusting beg
           void _trimL(size_t pos, bool lazy=true) {
-               auto indicies=get_indicies(pos);
-               for(short i=0; i<indicies.second; ++i)
-                    (*this)[indicies.first*cshift10d+i]=0;
-               beg_=indicies.first-1;
+               beg_=pos/cshift10d;
+               _set_digits(beg_*cshift10d,pos,0);
                _adjust_beg();
                if(!lazy)
                     _hard_trim_b4_beg_();
@@ -192,8 +232,7 @@ private:
                auto indicies=get_indicies(pos);
                if(indicies.first>=v_.size())
                     return;
-               for(short i=indicies.second+1; i<cshift10d; ++i)
-                    (*this)[indicies.first*cshift10d+i]=0;
+               _set_digits(pos+1,(indicies.first+1)*cshift10d,0);
                size_t start=indicies.first;
                if(v_[start]!=0)
                     start++;
@@ -221,15 +260,121 @@ private:
           ///@}
 
           void _propagate_carry(size_t pos, bool pos_is_cell_ix=false);
+          void _set_digits(long first, long last, short d);
           ostream& _print(ostream& os) const;
+          char* _digits_chars(char* p, long a, long b) const;
 
           int _abs_compare(const BigN& Y) const;
-          static BigN _add(const BigN& X, const BigN& Y);
-          static BigN _subtract(const BigN& X, const BigN& Y);
+          void _upscale(long s);
+          void _round(long scale, round_mode mode, bool sticky);
+          void _iaddsub(const BigN& Y, bool sub);
+          void _iaddsub_cells(const S* y, long yn, long yscale, bool sub);
+
+          /**\name Native Integer Kernels
+          Work on the magnitude of a native integer in place, in a single pass over the cells.
+          @{*/
+          static long _int_cells(u64 y, S* c);
+          ///The magnitude of a native integer
+          template<typename T>
+          static u64 _int_abs(T y) {
+               return y<0 ? u64(0)-u64(y) : u64(y);
+          }
+          void _iaddsub_int(u64 y, bool sub) {
+               S c[int_cells];
+               long n=_int_cells(y,c);
+               _iaddsub_cells(c,n,0,sub);
+          }
+          void _imul_int(u64 y);
+          bool _idiv_int(u64 y, long scale);
+          void _imod_int(u64 y);
+          int _abs_compare_int(u64 y) const;
+          ///@}
+
+          /**\name Conversions to Native Numbers
+          @{*/
+          u64 _int_part_abs() const;
+          ///The integral part, truncated toward zero and saturated at the limits of T
+          template<typename T>
+          T _to_native(true_type) const {
+               u64 m=_int_part_abs(), hi=u64(numeric_limits<T>::max());
+               if(sign_==PLUS || !*this)
+                    return m>hi ? numeric_limits<T>::max() : T(m);
+               if(!numeric_limits<T>::is_signed)
+                    return 0;
+               return m>hi ? numeric_limits<T>::min() : T(-T(m));
+          }
+          template<typename F>
+          F _to_native(false_type) const;
+          void _times_pow2(long e);
+          ///@}
           static BigN _lmultiply(const BigN&x, const BigN& y);
 
+          /**\name Multiplication Kernels
+          Work on raw, contiguous cells stored the same way as in v_ (most significant cell first).
+          A shorter operand is always aligned to the end (the least significant cell) of a longer one.
+          @{*/
+          static S _cells_add(S* r, long rn, const S* x, long xn);
+          static S _cells_sub(S* r, long rn, const S* x, long xn);
+          static void _cells_add_shifted(S* r, long rn, const S* x, long xn, long shift);
+          static S _cells_mul1(S* r, long rn, S m);
+          static S _cells_div1(S* r, long rn, S d);
+          static void _mul_cells(const S* a, long an, const S* b, long bn, S* r);
+          static void _mul_basecase(const S* a, long an, const S* b, long bn, S* r, long last=-1);
+          static bool _mul_short(const S* a, long an, const S* b, long bn, S* r, long cut);
+          static void _mul_high(const S* a, long an, const S* b, long bn, S* r, long last);
+          static void _sqr_basecase(const S* a, long an, S* r);
+          static void _mul_unbalanced(const S* a, long an, const S* b, long bn, S* r);
+          static void _mul_karatsuba(const S* a, long an, const S* b, long bn, S* r);
+          static void _toom3_eval(const S* x, long xn, long k, S t, S* e);
+          static void _mul_toom3(const S* a, long an, const S* b, long bn, S* r);
+          static void _ntt_pack(const S* x, long xn, vector<u32>& c);
+          static bool _mul_ntt(const S* a, long an, const S* b, long bn, S* r);
+          ///@}
+
+          /**\name Division Kernels
+          Work on raw cells like the multiplication kernels.
+          @{*/
+          static int _cells_cmp(const S* a, long an, const S* b, long bn);
+          static void _cells_shift10(Cells& x, long e);
+          static void _div_knuth(const S* u, long un, const S* v, long vn, S* q, S* r);
+          static void _div_knuth_scratch(S* nu, long un, S* nv, long vn, S* q, S* r);
+          static void _recip(const S* a, long n, Cells& x);
+          static void _div_newton(const S* u, long un, const S* v, long vn, Cells& q, Cells& r);
+          static void _divmod_cells(const S* u, long un, const S* v, long vn, Cells& q, Cells& r);
+          static void _divmod(const BigN& x, const BigN& y, long scale, BigN* q, BigN* r);
+          void _assign_cells(Cells& c, long scale, esign sign);
+          ///@}
+          ///BigFixed does its arithmetic with these kernels, on cells of its own
+          template<unsigned, unsigned, typename> friend class BigFixed;
+
 
 public:
+     ///Thrown on division by zero
+     struct exDivByZero : runtime_error {
+          exDivByZero() : runtime_error("Division by zero") {}
+     };
+     ///Thrown on reading an infinity or a NaN
+     struct exNotFinite : runtime_error {
+          exNotFinite() : runtime_error("Not a finite number") {}
+     };
+     /**\name Precision Context
+     Like bc's scale: quotients get div_scale digits behind the decimal point, and products get mul_scale, unless their operands have more (then they get as many as the longer one has).
+     Whatever doesn't fit is rounded off by *rounding*.
+     @{*/
+     ///The number of digits behind the decimal point that operator/= computes quotients to
+     static long div_scale;
+     ///The number of digits behind the decimal point that products keep at least as many of as their operands have; products are exact if it's negative
+     static long mul_scale;
+     ///How quotients and products are rounded to their scale
+     static round_mode rounding;
+     ///Sets div_scale and mul_scale to *scale* and rounding to *mode*, and returns *scale*; the BigN only picks the type
+     friend long set_precision(const BigN&, long scale, round_mode mode) {
+          div_scale=mul_scale=scale;
+          rounding=mode;
+          return scale;
+     }
+     ///@}
+
      void printinfo(ostream& os=cerr) const;
      void hard_trim() { _hard_trim(); }
 
@@ -239,56 +384,102 @@ public:
           short second=(pos<cshift10d) ? pos : pos%cshift10d;
           return {first,second};
      }
-     ///Index the BigN as if it were an array of decimal digits (0–9) -- writable version
-     typename CellR::Digit operator[](unsigned pos) {
-          auto indicies=get_indicies(pos);
-          return CellR(&v_[indicies.first])[indicies.second];
-     };
-     ///Index the BigN as if it were an array of decimal digits (0–9) -- const version
-     short operator[](unsigned pos) const {
-          auto indicies=get_indicies(pos);
-          return CellR(const_cast<S*>(&v_[indicies.first]))[indicies.second];
+     /**\brief A bidirectional iterator over the decimal digits (0–9) of the cells, numbered from the first digit of the first cell, as if the BigN were an array of them.
+     Each cell is split into its digits once, when the iterator first dereferences one of them, so walking the digits costs O(1) per digit.
+     \note Leading cells may be zero, and the digits of a cell are left-aligned; see digit_at()
+     */
+     class digit_iterator {
+          const S* v_;
+          long pos_;
+          mutable long dcell_;
+          mutable char d_[cshift10d];
+     public:
+          typedef bidirectional_iterator_tag iterator_category;
+          typedef short value_type;
+          typedef long difference_type;
+          typedef const short* pointer;
+          typedef short reference;
+
+          digit_iterator(const S* v, long pos) : v_(v), pos_(pos), dcell_(-1) {}
+          short operator*() const {
+               long c=pos_/cshift10d;
+               if(c!=dcell_) {
+                    fixed_digits(d_,v_[c],cshift10d);
+                    dcell_=c;
+               }
+               return d_[pos_%cshift10d]-'0';
+          }
+          digit_iterator& operator++() { ++pos_; return *this; }
+          digit_iterator& operator--() { --pos_; return *this; }
+          digit_iterator operator++(int) { digit_iterator r=*this; ++pos_; return r; }
+          digit_iterator operator--(int) { digit_iterator r=*this; --pos_; return r; }
+          bool operator==(const digit_iterator& o) const { return pos_==o.pos_; }
+          bool operator!=(const digit_iterator& o) const { return pos_!=o.pos_; }
+          ///The position of the digit, as taken by digit_at()
+          long pos() const { return pos_; }
      };
+     ///An iterator to the digit at pos, which counts from the first digit of the first (possibly zero) cell
+     digit_iterator digit_at(size_t pos) const { return digit_iterator(v_.data(),pos); }
+     digit_iterator digit_begin() const { return digit_at(0); }
+     digit_iterator digit_end() const { return digit_at(v_.size()*cshift10d); }
 
-     ///Rounds to n significant digits, used by the templated constructor for reading from floats
+     ///Rounds to n significant digits (half up), e.g. to cut a number read from a float back to the precision of its type
      void round2_n_sdigits(size_t n) {
-          n--;
-          size_t pad=_v_padding();
-          size_t nth=beg_+pad+n;
-          if((nth+1)>=v_.size())
-			return;
-
-          if((*this)[nth+1]>=5) {
-               (*this)[nth]=(*this)[nth]+1;
-               _propagate_carry(pad+n);
+          //The last digit kept
+          long nth=_v_padding()+n-1;
+          if(nth+1>=long(v_.size()*cshift10d))
+               return;
+          if(*digit_at(nth+1)>=5) {
+               size_t ncells=v_.size();
+               v_[nth/cshift10d]+=S(pten[cshift10d-1-nth%cshift10d]);
+               _propagate_carry(nth);
+               //A carry out of the first cell inserts one before it
+               nth+=(v_.size()-ncells)*cshift10d;
           }
-          _hard_trimR(pad+n);
+          _hard_trimR(nth);
      }
 
      ///Output: emulates std
-     friend ostream& operator<<(ostream& os, const BigN<S>& n) {
+     friend ostream& operator<<(ostream& os, const BigN& n) {
           return n._print(os);
      }
      ///Input: emulates std
-     friend istream& operator>>(istream& is, BigN<S>& n) {
+     friend istream& operator>>(istream& is, BigN& n) {
           n._read_in_from_a_stream(is);
           return is;
      }
 
 
+     ///Reads a number from the characters in [first,last), returning where it ends (first if there is no number)
+     const char* read(const char* first, const char* last);
+     ///An upper bound on the number of characters to_chars() writes
+     size_t chars_size() const;
+     ///Writes the number to [first,last), as operator<< does, returning the end of what was written (0 if it might not fit; chars_size() characters always do)
+     char* to_chars(char* first, char* last) const;
      ///Read from a stream (read!=BigN since support for delegated constructors does not exist in G++ 4.6
      BigN(istream& is) {
           _read_in_from_a_stream(is);
      }
-     ///Read from an input string; makes it into an istringstream buffer and then calls read()
+     ///Read from an input string by read()
      BigN(const char* istr) {
           _read_in_from_a_cstring(istr);
      }
-     ///Construct from native and floating point types; Floating point types will only be read up to their maximum decimal precision and then rounded
-     template<typename T=int>
+     ///Construct from native integer and floating point types; floating point numbers are read exactly, all digits of their binary value included (round2_n_sdigits() cuts them back to the type's precision)
+     template<typename T=int, typename=typename enable_if<is_arithmetic<T>::value>::type>
      BigN(T x=0) {
           _read_in_from_a_number<T>(x);
      }
+     ///The number that the characters C... of a literal write, from cells computed at compile time, which are only copied; see operator"" _bn()
+     template<char... C>
+     static BigN literal() {
+          typedef BigNLiteral<S,C...> L;
+          BigN r;
+          r.v_.assign(L::cells(),L::cells()+L::ncells);
+          r.beg_=0;
+          r.scale_=L::scale;
+          r._adjust_beg();
+          return r;
+     }
     ///Read in from a boolean (true==1, false==0)
      BigN (bool b) {
           _read_in_from_a_number(int(b));
@@ -296,9 +487,9 @@ public:
 
      ///Returns a value >=1 if *this>Y, 0 if *this==Y, and a value <=-1 if *this<Y
      int compare(const BigN& Y) const {
-          //If signs differ, we already know which is one greater than the other
+          //If signs differ, we already know which is one greater than the other (unless both are zeros)
           if(sign_!=Y.sign_)
-               return sign_==MINUS ? -1 : 1;
+               return !*this && !Y ? 0 : sign_==MINUS ? -1 : 1;
 
           int coeff= sign_==PLUS ? 1 : -1;
 
@@ -308,7 +499,7 @@ public:
  * @{ */
      /*ASSIGNMENT OPERATORS*/
      ///Default assignment from BigN
-     template<typename T>
+     template<typename T, typename=typename enable_if<is_arithmetic<T>::value>::type>
      BigN& operator=(T x) {
           _read_in_from_a_number(x);
           return *this;
@@ -322,18 +513,34 @@ public:
           return *this;
      }
 
-     //Default copy constructor
-     //Default move constructor
+     BigN(const BigN&)=default;
+     ///Takes over y's cells instead of copying them
+     BigN(BigN&& y)=default;
+     BigN& operator=(BigN&& y)=default;
+     ///Moves the cells out of a CellArena, onto the heap (or inline), so that they survive its reset
+     friend void leave_arena(BigN& x) {
+          if(x.v_.in_arena()) {
+               CellArena::Scope heap(0);
+               x.v_.shrink_to_fit();
+          }
+     }
+     ///Reserves cells for *digits* decimal digits, so that in-place operations with results up to that long don't reallocate
+     void reserve(size_t digits) {
+          v_.reserve(digits/cshift10d+2);
+     }
 
-     operator bool() const {
+     explicit operator bool() const {
           for(size_t i=beg_; i<v_.size(); i++)
                if(v_[i]) return true;
           return false;
      }
-     //TODO This is a hack. Works for argument counting, but should be redone ASAP.
-     /*operator int() const {
-               return v_[v_.size()-1]/pten[scale_];
-      }*/
+     /**\brief Converts to a native number in O(cells).
+     Floating point types get the correctly rounded (to nearest, ties to even) value, or an infinity if it's out of their range; integers get the integral part, truncated toward zero and saturated at the limits of their type.
+     */
+     template<typename T, typename=typename enable_if<is_arithmetic<T>::value && !is_same<T,bool>::value>::type>
+     explicit operator T() const {
+          return _to_native<T>(integral_constant<bool,numeric_limits<T>::is_integer>());
+     }
      BigN& operator-() {
           sign_= sign_==PLUS ? MINUS : PLUS;
           return *this;
@@ -350,55 +557,152 @@ public:
           sign_=y.sign_;
           return *this;
      }
-     class CellIterator;
 
 
-     //Add the absolute value of Y to the absolute value of (*this) without changing sign_
-
-     //Ops combined with assignment
+     //Ops combined with assignment; they work in place, reusing v_
      BigN& operator+=(const BigN& Y) {
-          if(sign_!=Y.sign_)
-               return Y.sign_==MINUS ?  (*this=_subtract(*this,Y)) : (*this=_subtract(Y,*this));
-          return (*this=_add(*this,Y));
+          if(this==&Y)
+               return *this+=BigN(Y);
+          _iaddsub(Y,sign_!=Y.sign_);
+          return *this;
      }
      BigN& operator-=(const BigN& Y) {
-          if(sign_!=Y.sign_)
-				return *this=_add(*this,Y);
-          bool flipsign = sign_==MINUS ? true : false;
-          *this=_subtract(*this,Y);
-          if (flipsign)
-			sign_ = sign_==PLUS ? MINUS : PLUS;
-		  return *this;
+          if(this==&Y)
+               return *this=0;
+          _iaddsub(Y,sign_==Y.sign_);
+          return *this;
      }
 
-     BigN& operator--() {
-          (*this)-=1;
+     /**\name Native Integer Operands
+     Adding, subtracting, multiplying, dividing and comparing with a native integer works on the cells in place, in one pass and without allocating, instead of turning the integer into a BigN first.
+     @{*/
+     template<typename T>
+     typename enable_if<is_integral<T>::value,BigN&>::type operator+=(T y) {
+          _iaddsub_int(_int_abs(y),(y<0)!=(sign_==MINUS));
           return *this;
      }
-     BigN& operator++() {
-          (*this)+=1;
+     template<typename T>
+     typename enable_if<is_integral<T>::value,BigN&>::type operator-=(T y) {
+          _iaddsub_int(_int_abs(y),(y<0)==(sign_==MINUS));
+          return *this;
+     }
+     template<typename T>
+     typename enable_if<is_integral<T>::value,BigN&>::type operator*=(T y) {
+          _imul_int(_int_abs(y));
+          if(y<0)
+               sign_= sign_==PLUS ? MINUS : PLUS;
+          if(!*this)
+               sign_=PLUS;
           return *this;
      }
+     ///Divides by y, rounding the quotient by *rounding* to div_scale digits behind the decimal point
+     template<typename T>
+     typename enable_if<is_integral<T>::value,BigN&>::type operator/=(T y) {
+          if(!y)
+               throw exDivByZero();
+          esign sign= (sign_==MINUS)!=(y<0) ? MINUS : PLUS;
+          bool inexact=_idiv_int(_int_abs(y), rounding==ROUND_DOWN ? div_scale : div_scale+1);
+          sign_=sign;
+          if(rounding!=ROUND_DOWN)
+               _round(div_scale,rounding,inexact);
+          if(!*this)
+               sign_=PLUS;
+          return *this;
+     }
+     template<typename T>
+     typename enable_if<is_integral<T>::value,BigN&>::type operator%=(T y) {
+          if(!y)
+               throw exDivByZero();
+          _imod_int(_int_abs(y));
+          return *this;
+     }
+     template<typename T>
+     typename enable_if<is_integral<T>::value,int>::type compare(T y) const {
+          if((sign_==MINUS)!=(y<0))
+               return !*this && !y ? 0 : sign_==MINUS ? -1 : 1;
+          int c=_abs_compare_int(_int_abs(y));
+          return sign_==MINUS ? -c : c;
+     }
+///Comparison operator *X* between a BigN and a native integer, on either side
+#define INT_CMP_(X) \
+     template<typename T> friend typename enable_if<is_integral<T>::value,bool>::type operator X (const BigN& x, T y) { return x.compare(y) X 0; } \
+     template<typename T> friend typename enable_if<is_integral<T>::value,bool>::type operator X (T y, const BigN& x) { return 0 X x.compare(y); }
+     INT_CMP_(==)
+     INT_CMP_(!=)
+     INT_CMP_(<)
+     INT_CMP_(>)
+     INT_CMP_(<=)
+     INT_CMP_(>=)
+#undef INT_CMP_
+     ///@}
+
+     BigN& operator--() {
+          return *this-=1;
+     }
+     BigN& operator++() {
+          return *this+=1;
+     }
 
      friend bool operator==(const BigN& x,const BigN& y) {
           return x.compare(y)==0;
      }
+     friend bool operator!=(const BigN& x,const BigN& y) {
+          return x.compare(y)!=0;
+     }
      friend bool operator<(const BigN& x, const BigN& y) {
           return x.compare(y)<0;
      }
      friend bool operator>(const BigN& x, const BigN& y) {
           return x.compare(y)>0;
      }
+     friend bool operator<=(const BigN& x, const BigN& y) {
+          return x.compare(y)<=0;
+     }
+     friend bool operator>=(const BigN& x, const BigN& y) {
+          return x.compare(y)>=0;
+     }
      BigN& operator*=(const BigN& y) {
           return *this=_lmultiply(*this,y);
      };
+     ///Squares the number; x*=x (or x*y with y equal to x) does the same
+     BigN& square() {
+          return *this=_lmultiply(*this,*this);
+     }
+     ///Divides by y, rounding the quotient by *mode* to *scale* digits behind the decimal point. Throws exDivByZero if y is zero.
+     BigN& divide(const BigN& y, long scale, round_mode mode=rounding) {
+          if(mode==ROUND_DOWN) {
+               _divmod(*this,y,scale,this,NULL);
+               return *this;
+          }
+          //One more digit, and whether anything comes after it, is all that rounding takes
+          esign sign= sign_==y.sign_ ? PLUS : MINUS;
+          BigN r;
+          _divmod(*this,y,scale+1,this,&r);
+          sign_=sign;
+          _round(scale,mode,bool(r));
+          return *this;
+     }
+     ///Rounds by *mode* to *scale* digits behind the decimal point
+     BigN& round(long scale, round_mode mode=rounding) {
+          _round(scale,mode,false);
+          return *this;
+     }
      BigN& operator/=(const BigN& y) {
+          return divide(y,div_scale);
+     }
+     ///Remainder of the division truncated to an integer; it has the sign of the dividend
+     BigN& operator%=(const BigN& y) {
+          _divmod(*this,y,0,NULL,this);
           return *this;
      }
+     ///Sets q to x/y truncated to an integer and r to x%y, doing the division only once
+     friend void divmod(const BigN& x, const BigN& y, BigN& q, BigN& r) {
+          _divmod(x,y,0,&q,&r);
+     }
 ///A non-assigning binary operator identified by *X*
 #define NONASS_BINOP_(X) inline BigN operator X (const BigN& y) const 	{ 	BigN mx=(*this); mx X##= y; return mx;  	}
-///A non-assigning binary operator identified by *X*; auto-converts the *y* parameter to BigN
-#define NONASS_BINOP2_(X) template<typename T> inline BigN operator X (T y) const	{ 	BigN mx=(*this); mx X##= BigN(y); return mx;  	}
+///A non-assigning binary operator identified by *X*; native integers go to the scalar kernels, other types are converted to BigN
+#define NONASS_BINOP2_(X) template<typename T> inline BigN operator X (T y) const	{ 	BigN mx=(*this); mx X##= y; return mx;  	}
      NONASS_BINOP_(+)
      NONASS_BINOP2_(+)
      NONASS_BINOP_(-)
@@ -407,32 +711,41 @@ public:
      NONASS_BINOP2_(*)
      NONASS_BINOP_(/)
      NONASS_BINOP2_(/)
+     NONASS_BINOP_(%)
+     NONASS_BINOP2_(%)
 #undef NONASS_BINOP_r
      //Ops with temporaries; made faster by means of move semantics
 ///A binary operator *X* applied to an rvalue x and a const y
-#define MOVE_OP_(X) inline friend BigN&& operator X (BigN&& x,const BigN& y) { x X##= y; return x; }
+#define MOVE_OP_(X) inline friend BigN&& operator X (BigN&& x,const BigN& y) { x X##= y; return move(x); }
      MOVE_OP_(+)
      MOVE_OP_(-)
      MOVE_OP_(*)
      MOVE_OP_(/);
+     MOVE_OP_(%);
 #undef MOVE_OP_
 ///A commutative binary operator *X* applied to a const x and an rvalue y
-#define MOVE_OP2_(X) inline friend BigN&& operator X (const BigN& x,BigN&& y) { y X##= x; return y; }
+#define MOVE_OP2_(X) inline friend BigN&& operator X (const BigN& x,BigN&& y) { y X##= x; return move(y); }
      MOVE_OP2_(+)
      MOVE_OP2_(*)
 ///If y is n rvalue and x isn't, turn it around and flip the sign
 inline friend BigN&& operator - (const BigN& x,BigN&& y) { y -= x; return -y; }
 
      friend string to_string(const BigN& x) {
-          stringstream ss;
-          ss<<x;
-          return ss.str();
+          string s(x.chars_size(),'\0');
+          s.resize(x.to_chars(&s[0],&s[0]+s.size())-&s[0]);
+          return s;
      }
    ///@}
 
 
 };
 
+///\brief A BigN literal, e.g. 123456789012345678901234567890_bn or 3.14159_bn. Its cells are computed at compile time, so nothing is parsed at run time.
+template<char... C>
+BigN<> operator"" _bn()
+{
+     return BigN<>::literal<C...>();
+}
 
 }
 
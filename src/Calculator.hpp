@@ -17,6 +17,7 @@
 #include "ShrdNum.hpp"
 #include "calculator_fns_and_ops.hpp"
 #include "bign_supplemental.hpp"
+#include "bign_arena.hpp"
 
 /**
  * \file
@@ -85,11 +86,16 @@ private:
 
      ///Vector/stack representing a line or semicolon-separated statement expressed in Reverse Polish Notation.
      vector<Tk*> rpn_;
+     ///Where the temporaries of a statement get their storage from, if T allocates it with an ArenaAllocator; reset after every statement
+     CellArena arena_;
 
      ///A reference to the stream the Calculator outputs into
      ostream& os_;
      ///Reference to a variable that stores the result of the last evaluated statement
      T& ans_;
+     ///References to the variables that set the precision context of T (see set_precision()): the digits behind the decimal point that quotients and products keep, and the round_mode they are rounded off by
+     T& scale_;
+     T& round_;
 
      ///\brief Purely Virtual Base of All Token Classes
      class Tk {
@@ -316,15 +322,16 @@ private:
      protected:
           U n_;
           fptr exec_;	 ///function to be executed upon function evaluation
+          string out_var_;	///<If not empty, exec_ gets an extra output argument after the n ones, which is then stored in this variable
      public:
-          FnT(const string& id, U n, fptr exec ) : Tk(id),n_(n),exec_(exec) {}
-          FnT(string&& id, U n, fptr exec ) : Tk(move(id)),n_(n),exec_(exec) {}
+          FnT(const string& id, U n, fptr exec, const string& out_var=string() ) : Tk(id),n_(n),exec_(exec),out_var_(out_var) {}
+          FnT(string&& id, U n, fptr exec, const string& out_var=string() ) : Tk(move(id)),n_(n),exec_(exec),out_var_(out_var) {}
           ///Evaluation makes use of the fact the vector in our CalcStackType is directly accessible.
 
           void eval(CalcStackType& comp_stack, Calculator& parent) {
                // arg1 arg2 arg3 argn
                auto p_last_valt=comp_stack.v_.end()-1;
-               int argsn = *(p_last_valt->get_scratch_p(parent));
+               int argsn = int(*(p_last_valt->get_scratch_p(parent)));
 
                vector<T*> args;
                args.reserve(argsn);
@@ -342,7 +349,12 @@ private:
                cout<<")"<<endl;
 #endif
 
+               T out;
+               if(!out_var_.empty())
+                    args.push_back(&out);
                this->exec_(argsn, args.data());
+               if(!out_var_.empty())
+                    parent.vars_[out_var_]=out;
 
                //pop all args from the computation stack
                for(int i=0; i<argsn; i++)
@@ -394,7 +406,26 @@ private:
      }
 
      int _run(bool should_print=true) ;
+     ///Makes scale_ and round_ the precision context of the statement about to run; a negative scale is taken as 0, an unknown rounding mode as ROUND_DOWN, and a type of a fixed scale (BigFixed) keeps its own, and the variables are set to that
+     void _set_precision() {
+          long scale=long(scale_);
+          int mode=int(round_);
+          if(scale<0)
+               scale_=scale=0;
+          if(mode<ROUND_DOWN || mode>ROUND_CEILING)
+               round_=mode=ROUND_DOWN;
+          long kept=set_precision(scale_,scale,round_mode(mode));
+          if(kept!=scale)
+               scale_=kept;
+     }
      eTk _getTkStr(istream& is, string& out_tok);
+     ///Reads a number from a string the way numbers in the input are read, so that constants don't go through a double
+     static T _num(const char* s) {
+          istringstream is(s);
+          T x;
+          is>>x;
+          return x;
+     }
 
 public:
 
@@ -417,13 +448,16 @@ public:
 #define OP_PO_(OPER_,PREC_,FUNC_) { OPER_, { OPER_, PREC_, Op::FUNC_ }}
 #define OP_INF_(OPER_,PREC_,FUNC_,ASSOC_,ASSIGN_) { OPER_, { OPER_, PREC_, Op::FUNC_,OpT::ASSOC_,ASSIGN_ }}
 #define FN_(FNAME_,ARGSN_) { #FNAME_, { #FNAME_, ARGSN_, Fn::FNAME_ }}
+#define FN_OUT_(FNAME_,ARGSN_,OUTVAR_) { #FNAME_, { #FNAME_, ARGSN_, Fn::FNAME_, OUTVAR_ }}
 
 ///The constructor specifies the functions operators, and variables that the Calculator instance is going to keep
      Calculator(ostream& os=cout) :
           vars_ {
-          {"Pi",3.14},
-          {"Ga",9.81},
-          {"E",2.41}
+          {"Pi",_num("3.14")},
+          {"Ga",_num("9.81")},
+          {"E",_num("2.41")},
+          {"scale",DIV_SCALE},
+          {"round",int(ROUND_DOWN)}
      },
      pr_ops_ {
           //RIGHT ASSOCIATIVE
@@ -441,7 +475,7 @@ public:
           OP_INF_("^",1,raise,R,0),
           OP_INF_("*",3,times,L,0),
           OP_INF_("/",3,div,L,0),
-          //OP_INF_("%",3,times,L,0),
+          OP_INF_("%",3,mod,L,0),
           OP_INF_("-",4,minus,L,0),
           OP_INF_("+",4,plus,L,0),
           OP_INF_("<",5,lt,L,0),
@@ -457,6 +491,7 @@ public:
           OP_INF_("-=",10,aminus,L,1),
           OP_INF_("*=",10,atimes,L,1),
           OP_INF_("/=",10,adiv,L,1),
+          OP_INF_("%=",10,amod,L,1),
           OP_INF_(",",12,noop,L,0)
      },
      fns_ {
@@ -466,14 +501,19 @@ public:
           FN_(avg,-1),
           FN_(min,-1),
           FN_(sum2,2),
+          FN_(prod,2),
+          FN_OUT_(divmod,2,"rem"),
           FN_(help,0)
 
      },
      opchars_(_opchars_init()),
               os_(os),
-              ans_(vars_["ans"])
+              ans_(vars_["ans"]),
+              scale_(vars_["scale"]),
+              round_(vars_["round"])
 
      {
+          _set_precision();
      }
 
 };
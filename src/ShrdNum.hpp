@@ -4,6 +4,10 @@
 #include <string>
 //#include <valarray>
 #include <memory>
+#include <type_traits>
+
+#include "bign_supplemental.hpp"
+#include "bign_arena.hpp"
 
 /** \file ShrdNum.hpp
  \brief This file contains ShrdNum templated class and some related functions. */
@@ -32,15 +36,20 @@ typedef ShrdNum<int> Shared
 
 template<typename T> class ShrdNum {
      shared_ptr<T> p_;
+     ///The value and its control block come from the active CellArena, if there is one
+     template<typename U>
+     static shared_ptr<T> _make(U&& val) {
+          return allocate_shared<T>(ArenaAllocator<T>(),forward<U>(val));
+     }
 public:
 
      ///The default constructor; initializes ShrdNum with T(0)
-     ShrdNum() : p_(new T(0)) {}
+     ShrdNum() : p_(_make(0)) {}
      /**!!!COPY CONSTRUCTOR—all copy-constructed copies (this especially affects function arguments,
      	regardless of whether or not they may be passed by value or by const references) will be effectively REFERENCES with write access to the original resource.
      */
      ShrdNum(const ShrdNum& x) : p_(x.p_) {}
-     template<typename U> 	ShrdNum(const U& val) : p_(new T(val)) {} 		///<Copy-constructs from whatever T can be copy-constructed from. A move version is not available as *val* types will always be small. 
+     template<typename U> 	ShrdNum(const U& val) : p_(_make(val)) {} 		///<Copy-constructs from whatever T can be copy-constructed from. A move version is not available as *val* types will always be small. 
      ShrdNum(ShrdNum&& x) : p_(std::move(x.p_)) {}					///<Move constructor.
 
 
@@ -81,6 +90,18 @@ public:
      size_t use_count() const {
           return p_.use_count();
      }
+     ///Moves the shared value, and its control block, out of a CellArena; whatever else shares them must be gone by its reset
+     friend void leave_arena(ShrdNum& x) {
+          if(CellArena::owner(x.p_.get())) {
+               CellArena::Scope heap(0);
+               x.p_=_make(move(*x.p_));
+          }
+          leave_arena(*x.p_);
+     }
+     ///Sets the precision context of T
+     friend long set_precision(const ShrdNum& x, long scale, round_mode mode) {
+          return set_precision(*x.p_,scale,mode);
+     }
      friend ostream& operator<<(ostream& os, const ShrdNum& x) {
           return os<<*x.p_;
      }
@@ -103,6 +124,14 @@ public:
      BIN_A_(/);
      BIN_A_(*);
 #undef BIN_A_
+///Macro to write the definitions of the =[+-%/ *] operators with a native number on the right, which goes to T as it is (T may have faster paths for it than for a converted T)
+#define BIN_AN_(X) template<typename U> friend typename enable_if<is_arithmetic<U>::value,ShrdNum&>::type operator X##= (ShrdNum& x, U y) { (*x.p_) X##= y; return x; }
+     BIN_AN_(+)
+     BIN_AN_(-)
+     BIN_AN_(%)
+     BIN_AN_(/)
+     BIN_AN_(*)
+#undef BIN_AN_
 ///Macro to write the definitions of operator < > >= <= == !=
 #define BIN_C_(X) friend bool operator X (const ShrdNum& x, const ShrdNum& y) { return (*x.p_ X *y.p_);  }
      BIN_C_(<);
@@ -112,6 +141,15 @@ public:
      BIN_C_(==);
      BIN_C_(!=);
 #undef BIN_C_
+///Macro to write the definitions of the comparison operators with a native number on the right
+#define BIN_CN_(X) template<typename U> friend typename enable_if<is_arithmetic<U>::value,bool>::type operator X (const ShrdNum& x, U y) { return (*x.p_ X y);  }
+     BIN_CN_(<)
+     BIN_CN_(>)
+     BIN_CN_(>=)
+     BIN_CN_(<=)
+     BIN_CN_(==)
+     BIN_CN_(!=)
+#undef BIN_CN_
 ///Macro to write the definitions of [+-%/ *] operators  when BOTH sides are LVALUES
 #define BIN_(X) friend ShrdNum operator X (const ShrdNum& x, const ShrdNum& y) { return (*x.p_ X *y.p_);  }
      BIN_(+);
@@ -128,6 +166,10 @@ public:
      RBIN_(/);
      RBIN_(*);
 #undef RBIN_
+     ///Quotient and remainder from a single division; see BigNum::divmod()
+     friend void divmod(const ShrdNum& x, const ShrdNum& y, ShrdNum& q, ShrdNum& r) {
+          divmod(*x.p_,*y.p_,*q.p_,*r.p_);
+     }
 
 ///Macro to write the definitions of [+*] operators (the commutative ones)  when the RIGHT operand is an RVALUE
 #define OP_(X) friend ShrdNum&& operator X (const ShrdNum& x, ShrdNum&& y) {  y X##= x; return std::move(y);  }
@@ -169,8 +211,11 @@ public:
      operator int() const {
           return int(*p_);
      }
+     operator long() const {
+          return long(*p_);
+     }
      operator double() const {
-          return int(*p_);
+          return double(*p_);
      }
 
 ///@}
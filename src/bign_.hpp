@@ -13,418 +13,153 @@
 
 #include "BigN.hpp"
 #include "bign_supplemental.hpp"
+#include "bign_ntt.hpp"
+#include "bign_simd.hpp"
 
 
 namespace BigNum {
 using namespace std;
 
-/** \brief A class that allows one-directional browsing through a virtual, properly aligned BigN.
- * The class circumvents the need to physically shift and pad BigN objects before an operations such as comparison, subtraction, or addition (i.e., an operation dependent on
- * proper alignment) can be performed. */
-
-template<typename S>
-class BigN<S>::CellIterator {
-private:
-     const BigN* p_; //ain't gonna change the data, just browse through it
-     size_t beg_padding_cells_;  ///< number of virtual padding cells at the beginning
-     size_t end_padding_cells_;  ///< number of virtual padding cells at the end
-     unsigned short shift10d_;	 ///< shift to the right in decimal digits
-     HalfST shift_;		 ///< 10^shift10d_
-     HalfST mask_;		 ///< BigN::cshift/shift_
-     bool fwd_;			 ///< goes forward?
-     long int ix_;		 ///< current index
-     HalfST val_;		 ///< current value
-     HalfST carry_;		 ///< current carry
-
-public:
-     ///Initialize the iterator
-     CellIterator(const BigN* p,
-                  bool fwd,
-                  size_t beg_padding_cells=0,
-                  size_t end_padding_cells=0,
-                  short shift10d=0)
-          : p_(p),
-            beg_padding_cells_(beg_padding_cells),
-            end_padding_cells_(end_padding_cells),
-            shift10d_(shift10d),
-            shift_(pten[shift10d]),
-            mask_(cshift/shift_),
-            fwd_(fwd), val_(0),carry_(0) {
-          ix_ = fwd_ ? p_->beg_ : p_->v_.size()-1;
-     };
-     size_t rescale(long int scale) {
-          if(scale > p_->scale_) {
-               end_padding_cells_=(scale-p_->scale_)/cshift10d;
-               if((scale-p_->scale_)%cshift10d)
-                    end_padding_cells_++;
-               shift10d_=p_->scale_+end_padding_cells_*cshift10d - scale;
-               DB("Rescaling a pseudo-BigN by "<<end_padding_cells_<<" cells; shift10d_="<<shift10d_);
-               
-
-               //If it's a backward iterator, then if shifting overflows to the first end_padding cell, then there's one less end_padding cell 
-               short endzs=(end_zeroes(p_->v_[p_->v_.size()-1])) ;
-               //The whole last cell is zeros
-               endzs = endzs ? endzs : cshift10d;
-			  
-               if(shift10d_ && !fwd_) {
-                    end_padding_cells_--;
-               }
-
-
-
-               return end_padding_cells_;
-          }
-          return 0;
-     }
-     ///\return number of relevant cells, i.e. cells since beg_ + padding cells at both the end and the beginning
-     long int rel_cells() const {
-          return p_->v_.size()-p_->beg_+end_padding_cells_+beg_padding_cells_;
-     }
-    ///Setter for setting the beg_padding_cells_ value after initialization
-     void pad(size_t beg_padding_cells) {
-          DB("Padding a pseudo-BigN by "<<beg_padding_cells<<" cells");
-          beg_padding_cells_=beg_padding_cells;
-     }
-     ///Make CellIterator ready for being browsed. Specify that no additional adjustment will be made from now on.
-     void ready() {
-          shift_=pten[shift10d_];
-          mask_=pten[cshift10d-shift10d_];
-
-          //If it's a forward iterator and shift10d == intdigits10d(v_[p->beg_])
-          if(fwd_ && ix_==p_->beg_ && _c_rel_digs(p_->v_[p_->beg_])==shift10d_)
-               this->operator ()();
-     }
-     ///Return value and move on to the next value.
-     HalfST operator() () {
-          if(fwd_) return _getfwd();
-          return _getreverse();
-     }
-private:
-     HalfST _getfwd() {
-          if (beg_padding_cells_)
-               beg_padding_cells_--;
-          else {
-               if (ix_ != (long) p_->v_.size()) {
-                    S cell = p_->v_[ix_];
-                    val_ = cell / shift_ + mask_*carry_;
-                    carry_ = p_->v_[ix_] % shift_;
-                    ix_++;
-               } else {
-                    if (carry_)	{
-                         val_ = carry_;
-                         carry_ = 0;
-                         return val_;
-                    }
-                    return 0;
-               }
-          }
-          return val_;
-     }
-     HalfST _getreverse() {
-          if(end_padding_cells_>0) {
-               DB_VAR(end_padding_cells_);
-               end_padding_cells_--;
-          } else {
-               if(ix_>=p_->beg_) {
-                    if(shift10d_) {
-                         val_=(p_->v_[ix_])%shift_*mask_+carry_;
-                         //carry this shifted value
-                         carry_=p_->v_[ix_]/shift_;
-                    } else {
-                         val_=p_->v_[ix_];
-                    }
-                    ix_--;
-               } else {
-                    if(carry_) {
-                         val_=carry_;
-                         carry_=0;
-                         return val_;
-                    }
-                    return 0;
-               }
-
-          }
-          return val_;
-     }
-
-
-};
-///A u8 specialization
-template<>
-class BigN<u8>::CellIterator {
-private:
-     typedef u8 S;
-     const BigN* p_; ///>won't' change the data, just browse through it
-     size_t beg_padding_cells_;
-     size_t end_padding_cells_;
-     bool fwd_;
-     long int ix_;
-
-public:
-     CellIterator(const BigN* p,
-                  bool fwd,
-                  size_t beg_padding_cells=0,
-                  size_t end_padding_cells=0,
-                  short shift10d=0)
-          : p_(p),
-            beg_padding_cells_(beg_padding_cells),
-            end_padding_cells_(end_padding_cells),
-            fwd_(fwd) {
-          ix_ = fwd_ ? p_->beg_ : p_->v_.size()-1;
-     };
-     size_t rescale(long int scale) {
-          if(scale > p_->scale_) {
-               end_padding_cells_=(scale-p_->scale_);
-               return end_padding_cells_;
-          }
-          return 0;
-
-     }
-
-     void pad(size_t beg_padding_cells) {
-          DB("Padding a pseudo-BigN by "<<beg_padding_cells<<" cells");
-          beg_padding_cells_=beg_padding_cells;
-     }
-     long int rel_cells() const {
-          return p_->v_.size()+end_padding_cells_+beg_padding_cells_-p_->beg_;
-     }
-     void ready() {
-     }
-     HalfST operator() () {
-          if(fwd_) return _getfwd();
-          return _getreverse();
-     }
-private:
-     HalfST _getfwd() {
-          if (beg_padding_cells_) {
-               beg_padding_cells_--;
-               return 0;
-          }
-          if (ix_ != (long) p_->v_.size()) {
-               S val= p_->v_[ix_++];
-               return val;
-          }
-          return 0;
-     }
-     HalfST _getreverse() {
-          if(end_padding_cells_) {
-               DB_VAR(end_padding_cells_);
-               end_padding_cells_--;
-               return 0;
-          }
-          if(ix_>=p_->beg_) {
-               S val= p_->v_[ix_--];
-               return val;
-          }
-
-          return 0;
+///Reads in the magnitude y of a native integer, with a minus sign if neg
+template<typename S, typename A>
+void BigN<S,A>::_read_in_from_an_int(u64 y, bool neg)
+{
+     S c[int_cells];
+     v_.assign(c,c+_int_cells(y,c));
+     beg_=0;
+     scale_=0;
+     sign_= neg ? MINUS : PLUS;
+     if(y)
+          _trim();
+}
+/** \brief Reads in a floating point number exactly.
+x is split into an integral mantissa and a power of two, which _times_pow2() multiplies it by, so no digit is computed in floating point arithmetic.
+\throw exNotFinite if x is an infinity or a NaN
+*/
+template<typename S, typename A>
+template<typename F>
+void BigN<S,A>::_read_in_from_a_number(F x, false_type)
+{
+     static_assert(numeric_limits<F>::digits<=64, "The mantissa must fit in a u64.");
+     if(!isfinite(x))
+          throw exNotFinite();
+     int e;
+     u64 m=u64(ldexp(frexp(fabs(x),&e),numeric_limits<F>::digits));
+     long e2=e-numeric_limits<F>::digits;
+     for(; m && !(m&1); m>>=1)
+          ++e2;
+     _read_in_from_an_int(m,x<0);
+     if(m)
+          _times_pow2(e2);
+}
+///Multiplies the magnitude by 2^e exactly; for e<0, that's multiplying by 5^-e and moving the decimal point -e digits to the left
+template<typename S, typename A>
+void BigN<S,A>::_times_pow2(long e)
+{
+     if(e>=0) {
+          for(; e>=32; e-=32)
+               _imul_int(u64(1)<<32);
+          _imul_int(u64(1)<<e);
+          return;
      }
+     scale_-=e;
+     for(; e<=-13; e+=13)
+          _imul_int(pten[13]>>13);
+     _imul_int(pten[-e]>>-e);
+}
+/**\brief Reads a number from the characters in [first,last): an optional sign, digits, and optionally a decimal point followed by more digits.
 
-
-};
-
-
-
-template<typename S>
-/** \brief Templated constructor for reading in BigN's from either floats or integers.
-
-BigN's read in this way are always left-aligned (padding()==0) and in the case of floats, the type's  precision is respected.
-\param x Number to read from.
+The digits go straight into whole cells, which are converted by digits_value() (8 digits at a time where possible).
+\return the end of the number; first if there is none (*this is zero then)
 */
-template<typename T>
-void BigN<S>::_read_in_from_a_number(T x)
+template<typename S, typename A>
+const char* BigN<S,A>::read(const char* first, const char* last)
 {
-     //initialize the BigN
      beg_=0;
      scale_=0;
-     v_.resize(0);
+     v_.clear();
      sign_=PLUS;
 
-     if(x==0) {
+     const char* p=first;
+     if(p!=last && (*p=='-' || *p=='+'))
+          sign_= *p++=='-' ? MINUS : PLUS;
+     const char* ibeg=p, *iend=skip_digits(p,last);
+     const char* fbeg=iend, *fend=iend;
+     if(iend!=last && *iend=='.')
+          fend=skip_digits(fbeg=iend+1,last);
+     if(ibeg==iend && fbeg==fend) {
           v_.push_back(0);
-          return;
-     };
-
-     if(x<0) {
-          x=-x;
-          sign_=MINUS;
+          sign_=PLUS;
+          return first;
      }
 
-     /*Make sure we don't read in digits that are within the type's error range.
-       This affects floating point types in particular */
-     unsigned precision=numeric_limits<T>::digits10+1;
-
-
-     /*Reserve cells for the integral part of the number and fill them up.
-     If the integral part is zero, then only start push'ing_back the fractional part cells after the first nonzero cell is found.
-     */
-     long int intreserve=0;
-     for(T xint_cp=floor(x); xint_cp; ++intreserve)
-          xint_cp=floor(xint_cp/cshift);
-
-     v_.resize(intreserve);
-
-
-     //Align to the left
-
-     if(intreserve) {
-          long int i=intreserve-1;
-
-          T intx=floor(x);
-          int x10d=_c_rel_digs(intx);
-          //How many digits to add to the first cell to make it left-aligned
-          int shift10d = (x10d%cshift10d)? cshift10d-(x10d%cshift10d) : 0;
-          S shift=pten[shift10d];
-          scale_+=shift10d;
-
-          //Start at the end of the integral part, and make sure it's properly shifted to the left
-          i = intreserve-1;
-          v_[i]=mod<T>(intx,static_cast<T>(cshift/shift))*shift;
-          intx/=(cshift/shift);
-          //Continue to the left
-          for(--i; i>=0 ; --i) {
-               v_[i]=mod(intx,static_cast<T>(cshift));
-               intx/=cshift;
+     //Zeros before the decimal point are skipped; the fractional digits follow the integral ones and the final cell is filled up with zeros
+     while(ibeg!=iend && *ibeg=='0')
+          ++ibeg;
+     long nint=iend-ibeg, nfrac=fend-fbeg, len=nint+nfrac;
+     long ncells=(len+cshift10d-1)/cshift10d;
+     if(!ncells) {
+          v_.push_back(0);
+          sign_=PLUS;
+          return fend;
+     }
+     v_.resize(ncells);
+     scale_=nfrac+ncells*cshift10d-len;
+     for(long i=0; i<ncells; ++i) {
+          long k=cshift10d, a=min(k,nint);
+          S c=0;
+          if(a) {
+               c=digits_value<S>(ibeg,a);
+               ibeg+=a;
+               nint-=a;
+               k-=a;
           }
-          //Erase the integral part from x
-          x=x-floor(x);
-          //If x has a fractional part and there was a shift, then the last digits of v_[v_.size()] should not be zeros, but come from the fractional part
-          if(x) {
-               x*=shift;
-               v_[v_.size()-1]+=floor(x);
-               x-=floor(x);
+          long b=min(k,nfrac);
+          if(b) {
+               c=S(c*pten[b]+digits_value<S>(fbeg,b));
+               fbeg+=b;
+               nfrac-=b;
+               k-=b;
           }
-     } else { //If there was no integral part, we need to zero in on the first nonzero cell and ensure proper alignment
-          for(; floor(x)==0; scale_+=cshift10d)
-               x*=cshift;
-          scale_+=cshift10d;
-
-          int x10d=_c_rel_digs(static_cast<S>(x));
-          int shift10d = x10d%cshift10d ? cshift10d-(x10d%cshift10d) : 0;
-          S shift=pten[shift10d];
-          x*=shift;
-          scale_+=shift10d;
-
-          S lastcell=static_cast<S>(x);
-          v_.push_back(lastcell);
-          x-=lastcell;
-
-
-     }
-     //This won't run if there was no fractional part
-     for(x*=cshift; x && v_.size()*cshift10d<precision; scale_+=cshift10d) {
-          if(v_.size()*cshift10d >= (precision+1))
-               break;
-
-          S lastcell=static_cast<S>(x);
-          v_.push_back(lastcell);
-          x-=lastcell;
-          x*=cshift;
+          v_[i]=S(c*pten[k]);
      }
-
-     //Round to precision
-     round2_n_sdigits(precision);
-
+     _adjust_beg();
+     if(!v_[beg_])
+          sign_=PLUS;
+     return fend;
 }
-///Function for reading in BigN's from an istream.
-template<typename S>
-std::istream& BigNum::BigN<S>::_read_in_from_a_stream(std::istream& is) //: len_(0),scale_(0),sign_(PLUS)
+///Function for reading in BigN's from an istream. The number's characters are taken from the stream buffer as they are and parsed by read().
+template<typename S, typename A>
+std::istream& BigNum::BigN<S,A>::_read_in_from_a_stream(std::istream& is)
 {
-     beg_=0;
-     scale_=0;
-     v_.resize(0);
-     sign_=PLUS;
-
-     size_t ix=0,len=0;
-
-     bool after_dp=false;
-     bool zero;
-
-     noskipws(is);
-     char c;
-     is>>c;
-     if(c=='0');
-     zero=true;
-     //ignore zeros before the decimal point
-     while(c=='0' && is>>c)
-          ;;
-
-     switch(c) {
-     case '-':
-          sign_=MINUS; //fall through
-     case '+':
-          break;
-     case '.':
-          after_dp=true;
-          break;
-     default:
-          if(!isdigit(c)) {
-               if(zero) {
-                    v_.push_back(0);
-                    is.putback(c);
-                    return is;
-               }
-               is.setstate(ios::failbit);
-          }
-          is.putback(c);
-          break;
-     };
-
-
-     //before decimal point
-     while(!after_dp && is>>c) {
-          if(!isdigit(c)) {
-               if(c!='.') {
-                    is.putback(c);
+     string buf;
+     istream::sentry ok(is);
+     if(ok) {
+          streambuf* sb=is.rdbuf();
+          bool dp=false;
+          for(int c=sb->sgetc(); ; c=sb->snextc()) {
+               if(c==EOF) {
+                    is.setstate(ios::eofbit);
                     break;
                }
-               after_dp=true;
-               break;
-          }
-          if(!(len%cshift10d)) {
-               v_.push_back(0);
-          }
-          ix=len++/cshift10d;
-          v_[ix]*=10;
-          v_[ix]+=_D(c);
-     }
-
-     while(after_dp && is>>c) {
-          if(!isdigit(c)) {
-               is.putback(c);
-               break;
+               if((c>='0' && c<='9') || ((c=='-' || c=='+') && buf.empty()))
+                    buf+=char(c);
+               else if(c=='.' && !dp) {
+                    buf+=char(c);
+                    dp=true;
+               } else
+                    break;
           }
-          if(!(len%cshift10d)) v_.push_back(0);
-          ix=len++/cshift10d;
-          v_[ix]*=10;
-          v_[ix]+=_D(c);
-          ++scale_;
-
      }
-     ///To behave the same as native number types
-     if(len==0) {
-          v_.push_back(0);
-          is.setstate(ios_base::failbit);
-          return is;
-     }
-
-     ///read to fill up the final cell
-     while((len-1)%cshift10d !=cshift10d-1) {
-          v_[ix]*=10;
-          ++scale_;
-          ++len;
-     }
-
-     _adjust_beg();
-
+     if(read(buf.data(),buf.data()+buf.size())==buf.data())
+          is.setstate(ios::failbit);
      return is;
-
 }
 ///Propagate carries (cell overflow in respect to cshift-1) from position pos to the left
 ///\arg pos position, either a digit position or a cell position
 ///\arg pos_is_cell_ix specifies, wheter pos is a cell index, otherwise it's considered to be a digit index
-template<typename S>
-void BigN<S>::_propagate_carry(size_t pos, bool pos_is_cell_ix)
+template<typename S, typename A>
+void BigN<S,A>::_propagate_carry(size_t pos, bool pos_is_cell_ix)
 {
      long marker=pos;
 
@@ -433,10 +168,10 @@ void BigN<S>::_propagate_carry(size_t pos, bool pos_is_cell_ix)
           marker=indicies.first;
      }
 
-     HalfST carry=v_[marker]/cshift;
+     S carry=v_[marker]/cshift;
      v_[marker]%=cshift;
 
-     for(; carry && marker>=beg_; --marker) {
+     for(--marker; carry && marker>=beg_; --marker) {
           v_[marker]+=carry;
           carry=v_[marker]/cshift;
           v_[marker]%=cshift;
@@ -446,273 +181,443 @@ void BigN<S>::_propagate_carry(size_t pos, bool pos_is_cell_ix)
           if(beg_) {
                beg_--;
                v_[beg_]=carry;
-          } else {
-               beg_--;
+          } else
                v_.insert(v_.begin(),carry);
-          }
      }
      return;
 }
-///Print *this to ostream os
-template<typename S>
-ostream& BigN<S>::_print(ostream& os) const
+/**\brief Sets the digits first..last-1 (numbered as by digit_iterator) to d.
+Works on whole cells: the digits of a cell that fall into the range are replaced by a repunit times d, without splitting the cell into its digits.
+*/
+template<typename S, typename A>
+void BigN<S,A>::_set_digits(long first, long last, short d)
 {
-	  ///digits in cells
-     long ndigs = _cells_since_beg()*cshift10d;
-    if(v_.size()==0 || ((v_.size()-beg_)==1 && v_[beg_]==0 ))
-          return os<<'0';
+     while(first<last) {
+          long c=first/cshift10d, o1=first%cshift10d, o2=min<long>(cshift10d,o1+last-first);
+          S hi=S(pten[cshift10d-o1]), lo=S(pten[cshift10d-o2]);
+          v_[c]=S(v_[c]/hi*hi+(hi-lo)/9*d+v_[c]%lo);
+          first+=o2-o1;
+     }
+}
+///Writes the digits a..b-1 of the cells from beg_ on (numbered from the first digit of v_[beg_]) to p, whole cells at a time
+template<typename S, typename A>
+char* BigN<S,A>::_digits_chars(char* p, long a, long b) const
+{
+     const S* c=v_.data()+beg_;
+     while(a<b) {
+          long off=a%cshift10d, n=min<long>(b-a,cshift10d-off);
+          if(n==cshift10d)
+               fixed_digits(p,c[a/cshift10d],cshift10d);
+          else {
+               char t[cshift10d];
+               fixed_digits(t,c[a/cshift10d],cshift10d);
+               memcpy(p,t+off,n);
+          }
+          p+=n;
+          a+=n;
+     }
+     return p;
+}
+template<typename S, typename A>
+size_t BigN<S,A>::chars_size() const
+{
+     long ndigs=_cells_since_beg()*cshift10d;
+     return 3+ndigs+(scale_>ndigs ? scale_-ndigs : 0)+(scale_<0 ? -scale_ : 0);
+}
+template<typename S, typename A>
+char* BigN<S,A>::to_chars(char* first, char* last) const
+{
+     if(last-first<long(chars_size()))
+          return 0;
+     char* p=first;
+     if(!*this) {
+          *p++='0';
+          return p;
+     }
      if(sign_==MINUS)
-          os<<'-';
-     long addz=0;
-     if(scale_>=ndigs) { ///all is behind the decimal point; might need to add additional leading zero cells
-          addz=scale_-ndigs;
-      
+          *p++='-';
+     long ncells=_cells_since_beg(), ndigs=ncells*cshift10d;
+     //The first and the last nonzero digit, and the digits before the decimal point
+     long fc=0, lc=ncells-1;
+     for(; !v_[beg_+fc]; ++fc)
+          ;;
+     for(; !v_[beg_+lc]; --lc)
+          ;;
+     long fz=fc*cshift10d+_c_beg_padding(beg_+fc);
+     long lz=lc*cshift10d+cshift10d-1-long(end_zeroes(v_[beg_+lc]));
+     long ip=ndigs-scale_;
+     if(fz<ip) {
+          p=_digits_chars(p,fz,min(ip,ndigs));
+          for(long i=ndigs; i<ip; ++i)
+               *p++='0';
+     }
 #ifdef ZEROPOINTX_
-          os<<'0'; //A zero before the decimal point is not printed, unless compiled with -DZEROPOINTX_
+     else
+          *p++='0'; //A zero before the decimal point is not printed, unless compiled with -DZEROPOINTX_
 #endif
-          long irrel_zs=_v_end_zs();
-          long end=(ndigs-irrel_zs)+beg_*cshift10d;
-          long i=beg_*cshift10d;
-          if(i>=end)
-               return os<<'0';
-          os<<'.';
-          for(long j=0; j<addz; ++j)
-               os<<'0';
-          for(; i<end; i++)
-               os<<(*this)[i];
-          return os;
-     } else if(scale_<=ndigs) { //there will be a dp inside the number
-          //strip leading zeros
-           long lzs=_c_beg_padding(beg_);
-          //first end at the decimal point
-          if(scale_>=0) {
-               long end=beg_*cshift10d+ndigs-scale_;
-               long i=beg_*cshift10d+lzs;
-               for(; i<end; ++i)
-                    os<<(*this)[i];
-               i=end; //we want to skip leading zeros, but not the ones after the decimal point and before the first significant digit
-               end+=scale_-_v_end_zs();
-               if(i>=end)
-                    return os;
-               os<<'.';
-               //f
-               for(; i<end; ++i)
-                    os<<(*this)[i];
-          } else {
-               long end=beg_*cshift10d+ndigs;
-               long i=beg_*cshift10d+lzs;
-               for(; i<end; ++i)
-                    os<<(*this)[i];
-               for(long i=0; i>scale_; --i)
-                    os<<'0';
-          }
+     if(lz>=ip) {
+          *p++='.';
+          for(long i=ip; i<0; ++i)
+               *p++='0';
+          p=_digits_chars(p,max(ip,0L),lz+1);
+     }
+     return p;
+}
+///Print *this to ostream os, formatted by to_chars() into a single buffer
+template<typename S, typename A>
+ostream& BigN<S,A>::_print(ostream& os) const
+{
+     char local[64];
+     size_t n=chars_size();
+     if(n<=sizeof local)
+          return os.write(local,to_chars(local,local+n)-local);
+     vector<char> buf(n);
+     return os.write(buf.data(),to_chars(buf.data(),buf.data()+n)-buf.data());
+}
+/**\brief Equivalent to BigN::compare, but ignores signs.
+
+The cells are compared as integers once Y is upscaled to the larger scale. If the scales differ by whole cells, that is a plain comparison of contiguous cells, followed by a check of the extra cells of *this;
+otherwise Y's cells are shifted on the fly, as in _iaddsub().
+*/
+template<typename S, typename A>
+int BigN<S,A>::_abs_compare(const BigN& Y) const {
+     if(scale_<Y.scale_)
+          return -Y._abs_compare(*this);
+     long e=scale_-Y.scale_;
+     long ec=e/cshift10d;
+     S m=pten[e%cshift10d], p=pten[cshift10d-e%cshift10d];
+     const S* x=v_.data()+beg_, *y=Y.v_.data()+Y.beg_;
+     long xn=_cells_since_beg(), yn=Y._cells_since_beg();
+     for(; xn && !*x; ++x, --xn)
+          ;;
+     for(; yn && !*y; ++y, --yn)
+          ;;
 
+     //Y's digits shifted to the left by e%cshift10d make one more cell at the front (if it's nonzero), and the whole cells of e add ec zero cells at the end
+     S hi= yn ? y[0]/p : 0;
+     long yl= yn ? yn+ec+(hi ? 1 : 0) : 0;
+     if(xn!=yl)
+          return xn>yl ? 1 : -1;
+     long i=0;
+     if(m==1) {
+          pair<const S*,const S*> mm=mismatch(x,x+yn,y);
+          if(mm.first!=x+yn)
+               return *mm.first>*mm.second ? 1 : -1;
+          i=yn;
+     } else {
+          if(hi) {
+               if(x[0]!=hi)
+                    return x[0]>hi ? 1 : -1;
+               i=1;
+          }
+          for(long j=0; j<yn; ++j, ++i) {
+               S yc=y[j]%p*m+(j+1<yn ? y[j+1]/p : 0);
+               if(x[i]!=yc)
+                    return x[i]>yc ? 1 : -1;
+          }
      }
-     return os<<flush;
-
-}
-template<>
-ostream& BigN<u8>::_print(ostream& os) const
-{
-     bool print_padding=false;
-     size_t end_pad=_v_end_zs();
-     size_t len=(v_.size()-beg_)*cshift10d;//-beg_padding()-end_pad;
-     if(len==0)
-          return os<<0;
-     long i=beg_*cshift10d;//+beg_padding();
-     long end=i+len;
-     long scale=scale_;//-end_pad;
-     if(!print_padding) {
-          len-=_c_beg_padding(beg_)+end_pad;
-          i+=_c_beg_padding(beg_);
-          scale-=end_pad;
-          end=i+len;
-     }
-     if(scale>=0) {
-          end-=scale;
-          //!!UNCOMMENT THIS TO PRINT A ZERO BEFORE THE DECIMAL POINT IF THERE IS NOT INTEGRAL PART
-          //if(i>=end) 	os<<'0';
-          for(; i<end; i++) {
-               os.put('0'+v_[i]);
+     for(; i<xn; ++i)
+          if(x[i])
+               return 1;
+     return 0;
+}
+/**\brief Cuts the magnitude to *scale* digits behind the decimal point, rounding it off by *mode*.
+\param sticky Whether anything nonzero comes after the cells (like the remainder of a quotient that was computed a digit further), which the cells only tell about themselves
+*/
+template<typename S, typename A>
+void BigN<S,A>::_round(long scale, round_mode mode, bool sticky)
+{
+     //The first digit cut off, counted like digit_at() does
+     long end=long(v_.size())*cshift10d, d=end-(scale_-scale);
+     if(d>=end && !sticky)
+          return;
+     //The first digit cut off and the last one kept (which only matters when the former is cut off)
+     short first=0, last=0;
+     if(d<end) {
+          if(d>=0) {
+               first=*digit_at(d);
+               sticky= sticky || v_[d/cshift10d]%pten[cshift10d-1-d%cshift10d];
           }
-          end+=scale;
-          if(i<end)
-               os<<'.';
-          for(; i<end; i++)
-               os.put('0'+v_[i]);
-     } else {
-          for(; i<end; i++)
-               os.put('0'+v_[i]);
-          for(i=0; i<-scale; i++)
-               os.put('0');
-     }
-     return os;
-}
-///Equivalent to BigN::compare, but ignores signs
-template<typename S>
-int BigN<S>::_abs_compare(const BigN& Y) const {
-                   #ifdef DEBUG
-                   cerr<<"COMPARING (abs)"<<endl;
-                   printinfo(cerr); cerr<<endl;
-                   Y.printinfo(cerr); cerr<<endl;                   
-				   #endif
-                                   
-                   CellIterator Xit(this,true);
-                   CellIterator Yit(&Y,true);
-
-                   size_t scale=max(scale_,Y.scale_);        
-
-                   Xit.rescale(scale);
-                   Yit.rescale(scale);
-                    
-                   size_t len=max(Xit.rel_cells(), Yit.rel_cells()) +1;
-                   DB_VAR(len);
-                   DB_VAR(Yit.end_padding_cells_);
-                   DB_VAR(Xit.end_padding_cells_);
-                   Xit.pad(len-Xit.rel_cells());
-	               Yit.pad(len-Yit.rel_cells());
-  
-                   Yit.ready();
-                   Xit.ready();
-  
-  
-                   //INTEGER DIGITS
-                   long intdigs1=(v_.size()-beg_)*cshift10d -_c_beg_padding(beg_)-scale_;
-                   long intdigs2=(Y.v_.size()-Y.beg_)*cshift10d -Y._c_beg_padding(Y.beg_)-Y.scale_;
-                   DB_VAR(intdigs1);
-                   DB_VAR(intdigs2);
-                   
-                   if(intdigs1-intdigs2) return (intdigs1-intdigs2);
-                   //Make sure beginnings are aligned
-                   
-                   int ret;
-                   long end =beg_+len;
-                   for(long i=beg_; i<end; ++i) {
-					   S xcell=Xit();
-					   S ycell=Yit();
-					   DB_VAR(xcell);
-					   DB_VAR(ycell);
-                        if((ret=xcell-ycell))
-                             return ret;
-                   }
-                   return 0;
-              }
-	///Does a virtual alignment of two numbers by means of CellIterators and then adds them together, returning a third BigN/
-	///The sign will be that of the first operand
-	template<typename S>
-           BigN<S> BigN<S>::_add(const BigN<S>& X, const BigN<S>& Y) {
-          #ifdef DEBUG
-                    cerr<<"ADDING"<<endl;
-					cerr<<"\t"<<X<<" + "<<Y<<endl;
-                    X.printinfo(cerr);
-                    cerr<<endl;
-                    Y.printinfo(cerr);
-                    cerr<<endl;
-          #endif
-                    CellIterator Yit(&Y,false);
-                    CellIterator Xit(&X,false);
-
-                    size_t scale=max(X.scale_,Y.scale_);        
-
-                    Xit.rescale(scale);
-                    Yit.rescale(scale);
-                    
-                    size_t len=max(Xit.rel_cells(), Yit.rel_cells())+1;
-
-                    
-                    BigN r;
-                    r.v_.resize(len,0);
-                    r.scale_=scale;
-
-                    r.sign_=X.sign_;
-
-                    Yit.ready();
-                    Xit.ready();
-                    long i=len-1;
-                    S carry=0;
-
-                    for(; i>=0; i--) {
-                         if((r.v_[i]=Xit()+Yit()+carry)>=cshift) {
-                              carry=r.v_[i]/cshift;
-                              r.v_[i]%=cshift;
-                         } else
-                              carry=0;
-
-                    }
-                    r._trim();
-                    #ifdef DEBUG
-					cerr<<"RESULT"<<r<<endl;
-					#endif
-                    return r;
+          for(long i= d>=0 ? d/cshift10d+1 : 0; i<(long)v_.size() && !sticky; ++i)
+               sticky= v_[i]!=0;
+          if(d>=1)
+               last=*digit_at(d-1);
+     }
+     bool up=round_away(mode,cut_rest(first,sticky),last%2,sign_==MINUS);
+     if(d<end) {
+          if(d<=long(_v_padding())) {
+               esign sign=sign_;
+               *this=0;
+               sign_=sign;
+          } else
+               _hard_trimR(d-1);
+     }
+     if(up) {
+          S one=1;
+          _iaddsub_cells(&one,1,scale,false);
+     }
+     if(!*this)
+          sign_=PLUS;
+}
+///Appends zeros to reach s>=scale_ digits behind the decimal point, in place
+template<typename S, typename A>
+void BigN<S,A>::_upscale(long s)
+{
+     long e=s-scale_;
+     if(e<=0)
+          return;
+     v_.resize(v_.size()+e/cshift10d,0);
+     if(e%cshift10d) {
+          //The digits shifted out of the first cell need a cell before it
+          if(beg_)
+               --beg_;
+          else
+               v_.insert(v_.begin(),S(0));
+          _cells_mul1(v_.data()+beg_,v_.size()-beg_,pten[e%cshift10d]);
+     }
+     scale_=s;
+}
+/**\brief Adds the magnitude of Y to that of *this, or subtracts it if sub is true, in place.
 
+*this is upscaled to the larger scale of the two (or a little further, to line its cells up with a long addend's for the vector kernels), and Y's cells are shifted to match it on the fly, so neither operand is copied, and v_ only grows when the result needs more cells than it has.
+If a subtraction goes below zero, the ten's complement of the cells is taken and the sign flips.
+\note Y must not be *this.
+*/
+template<typename S, typename A>
+void BigN<S,A>::_iaddsub(const BigN& Y, bool sub)
+{
+     _iaddsub_cells(Y.v_.data()+Y.beg_,Y._cells_since_beg(),Y.scale_,sub);
+}
+///Does _iaddsub() with the yn raw cells at y (most significant first) taken as the magnitude y*10^-yscale
+template<typename S, typename A>
+void BigN<S,A>::_iaddsub_cells(const S* y, long yn, long yscale, bool sub)
+{
+     long s=max(scale_,yscale);
+#ifdef BIGN_SIMD_ADD_
+     //Long operands are worth lining up with Y's cells (which then stays so for further additions of equally aligned numbers): that lets the vector kernels add them
+     if(yn>=SIMD_ALIGN_THRESHOLD)
+          s+=((yscale-s)%cshift10d+cshift10d)%cshift10d;
+#endif
+     _upscale(s);
+     long e=scale_-yscale;
+     long ec=e/cshift10d;
+     //Shifting a cell left by e%cshift10d digits: its last digits are multiplied by m and its first ones go to the next cell
+     S m=pten[e%cshift10d], p=pten[cshift10d-e%cshift10d];
+
+     //Room for all of the shifted Y and a carry
+     long need=max(yn+ec+1,_cells_since_beg())+1;
+     if((long)v_.size()<need)
+          v_.insert(v_.begin(),need-v_.size(),S(0));
+     beg_=v_.size()-need;
+
+     S* x=v_.data();
+     S carry=0, hi=0;
+     long i=v_.size()-1-ec;
+     if(m==1) {
+          //Cell-aligned: the cell kernels do it, and carry through the cells before Y's
+          carry= sub ? _cells_sub(x+beg_,i+1-beg_,y,yn) : _cells_add(x+beg_,i+1-beg_,y,yn);
+          i=beg_-1;
+     } else for(long j=yn-1; j>=-1; --j, --i) {
+          S yc=hi;
+          if(j>=0) {
+               yc+=y[j]%p*m;
+               hi=y[j]/p;
+          }
+          if(sub) {
+               yc+=carry;
+               if(yc>x[i]) {
+                    x[i]=x[i]+cshift-yc;
+                    carry=1;
+               } else {
+                    x[i]-=yc;
+                    carry=0;
                }
-	///Does a virtual alignment of two numbers by means of CellIterators and then subtracts
-	///the lesser of Y and *this from the greater one of the two; the sign will be plus if the first one had a greater (absolute) magnitude, or minus if not
-	template<typename S>
-             BigN<S> BigN<S>::_subtract(const BigN<S>& X, const BigN<S>& Y) {
-        #ifdef DEBUG
-                  X.printinfo(cerr);
-                  Y.printinfo(cerr);
-                  cerr<<"SUBTRACTING"<<endl;
-                  cerr<<"\t"<<X<<" - "<<Y<<endl;
-        #endif
-
-                  //Assume X.sign_=Y.sign_
-                  BigN r;
-                  const BigN *px, *py;
-                  px=&X;
-                  py=&Y;
-
-                  r.sign_=PLUS;
-
-                  if(X._abs_compare(Y)<0) {
-                       swap(px,py);
-                       r.sign_ = MINUS;
-                  }
-
-                  //PVAR(r.sign_);
-                  //if(px!=&X) cout<<"SWAPPED"<<endl;
-                  CellIterator Xit(px,false);
-                  CellIterator Yit(py,false);
-
-                  size_t scale=max(px->scale_,py->scale_);
-           
-
-                  Xit.rescale(scale);
-                  Yit.rescale(scale);
-                    
-                  size_t len=max(Xit.rel_cells(), Yit.rel_cells())+1;
-
-                  r.v_.resize(len,0);
-                  r.scale_=scale;
-
-                  Yit.ready();
-                  Xit.ready();
-                  long i=len-1;
-
-                  S borrow=0;
-
-                  for(; i>=0; i--) {
-                       S xx=Xit();
-                       S sub=Yit()+borrow;
-                       if(sub>xx) {
-                            r.v_[i]=xx+cshift-sub;
-                            borrow=1;
-                       } else {
-                            r.v_[i]=xx-sub;
-                            borrow=0;
-                       }
-                  }
-                  r._trim();
-        #ifdef DEBUG
-                  r.printinfo(cerr);
-                  cerr<<"RESULT"<<r<<endl;
-        #endif
-                  return r;
-             }
-		///Does long multiplication of x and y. If sizeof(S) > sizeof(unsigned char), this will be very fast.
-		template<typename S>
-              BigN<S> BigN<S>::_lmultiply(const BigN<S>&x, const BigN<S>& y) {
+          } else {
+               x[i]+=yc+carry;
+               if(x[i]>=cshift) {
+                    x[i]-=cshift;
+                    carry=1;
+               } else
+                    carry=0;
+          }
+     }
+     if(sub) {
+          for(; carry && i>=beg_; --i) {
+               if(x[i]==0)
+                    x[i]=cshift-1;
+               else {
+                    x[i]--;
+                    carry=0;
+               }
+          }
+          //|Y|>|*this|: negate the ten's complement
+          if(carry) {
+               S borrow=0;
+               for(i=v_.size()-1; i>=beg_; --i) {
+                    S d=x[i]+borrow;
+                    x[i]= d ? cshift-d : 0;
+                    borrow= d ? 1 : 0;
+               }
+               sign_= sign_==PLUS ? MINUS : PLUS;
+          }
+     } else {
+          for(; carry; --i) {
+               if(++x[i]==cshift)
+                    x[i]=0;
+               else
+                    carry=0;
+          }
+     }
+     _trim();
+     if(v_.empty() || !v_[beg_])
+          sign_=PLUS;
+}
+///Splits the magnitude y into cells, most significant first, writing them to c (which needs room for int_cells of them)
+///\return the number of cells
+template<typename S, typename A>
+long BigN<S,A>::_int_cells(u64 y, S* c)
+{
+     S t[int_cells];
+     long n=0;
+     do {
+          t[n++]=S(y%cshift);
+          y/=cshift;
+     } while(y);
+     reverse_copy(t,t+n,c);
+     return n;
+}
+///Multiplies the magnitude by y in one pass, unless y times a cell might not fit in a WideST (y above 10^10 or so, with 9-digit cells), which goes through _lmultiply()
+template<typename S, typename A>
+void BigN<S,A>::_imul_int(u64 y)
+{
+     if(WideST(y)>WideST(~WideST(0))/cshift) {
+          *this*=BigN(y);
+          return;
+     }
+     S* x=v_.data();
+     WideST carry=0;
+     for(long i=v_.size()-1; i>=beg_; --i) {
+          WideST t=WideST(x[i])*y+carry;
+          x[i]=S(t%cshift);
+          carry=t/cshift;
+     }
+     for(; carry; carry/=cshift) {
+          if(beg_)
+               --beg_;
+          else
+               v_.insert(v_.begin(),S(0));
+          v_[beg_]=S(carry%cshift);
+     }
+     _trim();
+}
+///Divides the magnitude by y in one pass, truncating the quotient to scale digits behind the decimal point; divisors too large for a WideST remainder go through _divmod()
+///\return whether anything was truncated, i.e. the quotient is inexact
+template<typename S, typename A>
+bool BigN<S,A>::_idiv_int(u64 y, long scale)
+{
+     if(WideST(y)>WideST(~WideST(0))/cshift) {
+          esign sign=sign_;
+          sign_=PLUS;
+          BigN r;
+          _divmod(*this,BigN(y),scale,this,&r);
+          sign_=sign;
+          return bool(r);
+     }
+     _upscale(scale);
+     S* x=v_.data();
+     WideST rem=0;
+     for(long i=beg_; i<(long)v_.size(); ++i) {
+          WideST t=rem*cshift+x[i];
+          x[i]=S(t/y);
+          rem=t%y;
+     }
+     bool inexact= rem!=0;
+     //Digits beyond scale, which *this may have had before
+     long extra=scale_-scale;
+     if(extra/cshift10d>=_cells_since_beg()) {
+          inexact= inexact || bool(*this);
+          *this=0;
+          return inexact;
+     }
+     if(extra>0) {
+          for(long i=v_.size()-extra/cshift10d; i<(long)v_.size() && !inexact; ++i)
+               inexact= x[i]!=0;
+          v_.erase(v_.end()-extra/cshift10d,v_.end());
+          scale_-=extra/cshift10d*cshift10d;
+          S p=pten[extra%cshift10d];
+          if(!v_.empty()) {
+               inexact= inexact || v_.back()%p;
+               v_.back()=v_.back()/p*p;
+          }
+     }
+     _trim();
+     return inexact;
+}
+///Replaces the magnitude by its remainder after an integral quotient by y: the integral part modulo y plus the fractional part
+template<typename S, typename A>
+void BigN<S,A>::_imod_int(u64 y)
+{
+     if(WideST(y)>WideST(~WideST(0))/cshift) {
+          esign sign=sign_;
+          sign_=PLUS;
+          _divmod(*this,BigN(y),0,NULL,this);
+          if(*this)
+               sign_=sign;
+          return;
+     }
+     if(scale_<0)
+          _upscale(0);
+     //Cell u holds the units digit, followed by fd fractional digits
+     long u=v_.size()-1-scale_/cshift10d, fd=scale_%cshift10d;
+     if(u<beg_)
+          return;
+     S* x=v_.data();
+     WideST rem=0;
+     for(long i=beg_; i<u; ++i) {
+          rem=(rem*cshift+x[i])%y;
+          x[i]=0;
+     }
+     rem=(rem*pten[cshift10d-fd]+x[u]/pten[fd])%y;
+     x[u]%=pten[fd];
+     _iaddsub_int(u64(rem),false);
+}
+///Compares the magnitude with y, reading the integral part only as far as it takes to exceed y
+///\return 1 if it's larger, 0 if it's equal and -1 if it's smaller
+template<typename S, typename A>
+int BigN<S,A>::_abs_compare_int(u64 y) const
+{
+     const S* x=v_.data();
+     long n=v_.size(), u=n-1, fd=0;
+     if(scale_>0) {
+          u-=scale_/cshift10d;
+          fd=scale_%cshift10d;
+     }
+     u64 r=0;
+     for(long i=beg_; i<=u; ++i) {
+          u64 c= i<u ? x[i] : x[i]/pten[fd], base= i<u ? u64(cshift) : pten[cshift10d-fd];
+          //r*base+c>y
+          if(y<c || r>(y-c)/base)
+               return 1;
+          r=r*base+c;
+     }
+     for(long i=scale_; i<0; ++i) {
+          if(r>y/10)
+               return 1;
+          r*=10;
+     }
+     if(r!=y)
+          return r<y ? -1 : 1;
+     if(u>=beg_ && x[u]%pten[fd])
+          return 1;
+     for(long i=max(u+1,beg_); i<n; ++i)
+          if(x[i])
+               return 1;
+     return 0;
+}
+		///Multiplies x and y. The cells since beg_ are multiplied as integers by BigN::_mul_cells, which picks the multiplication algorithm depending on their length.
+		///Equal operands are passed to it as the same cells, so that it squares them.
+		template<typename S, typename A>
+              BigN<S,A> BigN<S,A>::_lmultiply(const BigN<S,A>&x, const BigN<S,A>& y) {
                   BigN r;
                   // Note: Assignment multiplication provides no speed benefits; have to create a temporary in either case
                   #ifdef DEBUG
@@ -733,58 +638,763 @@ int BigN<S>::_abs_compare(const BigN& Y) const {
                   long xlen=x._cells_since_beg(), ylen=y._cells_since_beg();
                   r.v_.resize(xlen+ylen,0);
                   r.scale_=x.scale_+y.scale_;
-                  const BigN *pa=&x, *pb=&y;
-                  long alen=xlen;
-                  if(xlen<ylen) {
-                       swap(pa,pb);
-                       alen=ylen;
-                  }
-                  const BigN /*&a=*pa,*/ &b=*pb;
-
-                  CellIterator aIt(pa,0);
-                  long skip_cells=0;
-                  S carry=0;
-                  for(long i=long(b.v_.size())-1; i>=b.beg_; --i) {
-                       CellIterator aIt(pa,0);
-                       aIt.ready();
-                       S B=b.v_[i];
-                       long ri=r.v_.size()-1-skip_cells;
-                       long ri_stop=ri-alen-1; //one more than alen to allow for the carry to carry over
-                       //Cap(S)>Cap10(HalfS)^2+Cap10(HalfS) ... i.e., there will always be plenty of space inside each cell
-
-                       for(; ri>ri_stop; --ri) {
-                            r.v_[ri]+=aIt()*B+carry;
-                            if(r.v_[ri]>=cshift) {
-                                 carry=r.v_[ri]/cshift;
-                                 r.v_[ri]%=cshift;
-                            } else
-                                 carry=0;
-                       }
-                       skip_cells++;
-                  }
+                  //The scale the precision context allows for, which depends on the operands' digits behind the decimal point (not counting the zeros that their last cells are padded with)
+                  long scale=r.scale_;
+                  if(mul_scale>=0)
+                       scale=min(scale,max(mul_scale,max(x.scale_-long(x._v_end_zs()),y.scale_-long(y._v_end_zs()))));
+                  const S* xc=&x.v_[x.beg_], *yc=&y.v_[y.beg_];
+                  if(xc!=yc && xlen==ylen && equal(xc,xc+xlen,yc))
+                       yc=xc;
+                  if(scale==r.scale_ || !_mul_short(xc,xlen,yc,ylen,&r.v_[0],r.scale_-scale))
+                       _mul_cells(xc,xlen,yc,ylen,&r.v_[0]);
                   r._trim();
+                  if(scale<r.scale_)
+                       r._round(scale,rounding,false);
                   #ifdef DEBUG
                   cerr<<"RESULT"<<r<<endl;
 				  #endif
                   return r;
              }
+///Adds x to r, where both are raw cell arrays and x is aligned to the end of r (xn<=rn).
+///\return the carry out of r[0]
+template<typename S, typename A>
+S BigN<S,A>::_cells_add(S* r, long rn, const S* x, long xn)
+{
+     S carry=cells_addsub(r+rn-xn,x,xn,S(cshift),false);
+     long i=rn-1-xn;
+     for(; carry && i>=0; --i) {
+          if(++r[i]==cshift)
+               r[i]=0;
+          else
+               carry=0;
+     }
+     return carry;
+}
+///Subtracts x from r, where both are raw cell arrays and x is aligned to the end of r (xn<=rn).
+///\return the borrow out of r[0] (nonzero if x was greater than r)
+template<typename S, typename A>
+S BigN<S,A>::_cells_sub(S* r, long rn, const S* x, long xn)
+{
+     S borrow=cells_addsub(r+rn-xn,x,xn,S(cshift),true);
+     long i=rn-1-xn;
+     for(; borrow && i>=0; --i) {
+          if(r[i]==0)
+               r[i]=cshift-1;
+          else {
+               r[i]--;
+               borrow=0;
+          }
+     }
+     return borrow;
+}
+///Adds x, shifted to the left by shift cells, to r. Leading zero cells of x are skipped, so x may be longer than what fits in r as long as its value does.
+template<typename S, typename A>
+void BigN<S,A>::_cells_add_shifted(S* r, long rn, const S* x, long xn, long shift)
+{
+     for(; xn>rn-shift && !*x; --xn, ++x)
+          ;;
+     _cells_add(r,rn-shift,x,xn);
+}
+///Multiplies the raw cell array r by a small factor m in place
+///\return the carry out of r[0]
+template<typename S, typename A>
+S BigN<S,A>::_cells_mul1(S* r, long rn, S m)
+{
+     WideST carry=0;
+     for(long i=rn-1; i>=0; --i) {
+          WideST t=WideST(r[i])*m+carry;
+          r[i]=t%cshift;
+          carry=t/cshift;
+     }
+     return carry;
+}
+///Divides the raw cell array r by a single-cell divisor d (0<d<cshift) in place
+///\return the remainder
+template<typename S, typename A>
+S BigN<S,A>::_cells_div1(S* r, long rn, S d)
+{
+     WideST rem=0;
+     for(long i=0; i<rn; ++i) {
+          WideST t=rem*cshift+r[i];
+          r[i]=t/d;
+          rem=t%d;
+     }
+     return rem;
+}
+/**\brief Multiplies two raw cell arrays, writing all an+bn cells of the product into r.
 
+Leading zero cells are skipped, the longer operand is put first, and the product is then handed to the kernel that suits the operand lengths:
+long multiplication below BigN::kmul_threshold, number-theoretic transforms from BigN::ntt_threshold on (unless the operands are too long for them),
+and in between Karatsuba below BigN::toom3_threshold and Toom-Cook 3-way above it for operands of comparable length, and a split into pieces of the shorter operand's length for unbalanced ones.
+If a and b are the same cells (and so an==bn), every tier squares instead: _sqr_basecase() computes each cross product once, and the other kernels evaluate the operand only once and square their pieces.
+\note r must not overlap with a or b.
+*/
+template<typename S, typename A>
+void BigN<S,A>::_mul_cells(const S* a, long an, const S* b, long bn, S* r)
+{
+     long lz=0;
+     for(; an && !*a; --an, ++a)
+          lz++;
+     for(; bn && !*b; --bn, ++b)
+          lz++;
+     fill(r,r+lz,S(0));
+     r+=lz;
+     if(an<bn) {
+          swap(a,b);
+          swap(an,bn);
+     }
+     if(!bn) {
+          fill(r,r+an,S(0));
+          return;
+     }
+     if(bn<kmul_threshold) {
+          if(a==b)
+               _sqr_basecase(a,an,r);
+          else
+               _mul_basecase(a,an,b,bn,r);
+     } else if(bn>=ntt_threshold && _mul_ntt(a,an,b,bn,r))
+          return;
+     else if(an>=2*bn)
+          _mul_unbalanced(a,an,b,bn,r);
+     else if(bn<toom3_threshold)
+          _mul_karatsuba(a,an,b,bn,r);
+     else
+          _mul_toom3(a,an,b,bn,r);
+}
+/**\brief Long multiplication of raw cell arrays, column by column (Comba).
 
+All the products a[i]*b[j] of a column of the result are summed up in a WideST before the column is normalized, and whatever exceeds a cell is carried into the next column as a whole.
+Where cells are wide enough that a WideST only holds a few such products (u64 cells), the sum is folded into the carry every column_block products.
+*/
+template<typename S, typename A>
+void BigN<S,A>::_mul_basecase(const S* a, long an, const S* b, long bn, S* r, long last)
+{
+     WideST carry=0;
+     //a[i]*b[j] lands at r[i+j+1]
+     for(long k= last<0 ? an+bn-1 : last; k>=0; --k) {
+          WideST acc=carry;
+          carry=0;
+          long i=max(0L,k-bn), iend=min(an,k);
+          while(i<iend) {
+               long stop=min(iend,i+column_block);
+               for(; i<stop; ++i)
+                    acc+=WideST(a[i])*b[k-1-i];
+               if(i<iend) {
+                    carry+=acc/cshift;
+                    acc%=cshift;
+               }
+          }
+          r[k]=acc%cshift;
+          carry+=acc/cshift;
+     }
+}
+/**\brief A truncated product: the cells of a*b up to the cut digits at the end of r, and enough guard cells after them to round it off; the rest of r is zeroed.
+The products left out land after the guard cells, and they add less than min(an,bn)*cshift to the last of them (and less than one more, for the part of _mul_high()'s result that is zeroed).
+So there are as many guard cells as it takes for that to be less than one in the first of them; unless that one is cshift-1, nothing carries out of them, the cells before them are those of the full product,
+and the guard cells tell whether anything comes after the cut, which is all that rounding it off takes.
+\return whether that works out; if not (or if there is next to nothing to leave out), r isn't the product
+*/
+template<typename S, typename A>
+bool BigN<S,A>::_mul_short(const S* a, long an, const S* b, long bn, S* r, long cut)
+{
+     long n=an+bn, c=(n*cshift10d-cut)/cshift10d, last=c+2;
+     for(long m=min(an,bn)-1; m>0; m/=cshift)
+          ++last;
+     if(n*cshift10d<cut || last>=n-1)
+          return false;
+     _mul_high(a,an,b,bn,r,last);
+     fill(r+last+1,r+n,S(0));
+     if(r[c+1]==S(cshift-1))
+          return false;
+     for(long k=c+1; k<=last; ++k)
+          if(r[k])
+               return true;
+     return false;
+}
+/**\brief The high part of a product, after Mulders: r gets the sum of some of the products a[i]*b[j], among them all of those that land in r[0..last] (i+j+1<=last), normalized over all an+bn cells.
+Those have i<k or j<k for a k of 70% of last (but at least half of it): the leading k cells of a and b are multiplied in full by _mul_cells(), so by Karatsuba or a faster tier if they are long enough,
+and the rest are the high parts of a[k..an)*b and a*b[k..bn), which are cut short enough that they only take about a third of last cells of the other operand. Squares need only one of them.
+Operands shorter than BigN::kmul_threshold get the columns up to last of long multiplication instead.
+\note r must not overlap with a or b.
+*/
+template<typename S, typename A>
+void BigN<S,A>::_mul_high(const S* a, long an, const S* b, long bn, S* r, long last)
+{
+     long n=an+bn;
+     if(last>=n-1) {
+          _mul_cells(a,an,b,bn,r);
+          return;
+     }
+     if(min(an,bn)<kmul_threshold) {
+          _mul_basecase(a,an,b,bn,r,last);
+          fill(r+last+1,r+n,S(0));
+          return;
+     }
+     long k=max(7*last/10,(last+1)/2), ka=min(an,k), kb=min(bn,k);
+     _mul_cells(a,ka,b,kb,r);
+     fill(r+ka+kb,r+n,S(0));
+     Cells t;
+     //a[ka..an)*b[0..jb): everything of it lands ka cells further on than in a product of its own
+     long jb=min(bn,last-ka);
+     if(ka<an && jb>0) {
+          t.resize(an-ka+jb);
+          _mul_high(a+ka,an-ka,b,jb,t.data(),last-ka);
+          _cells_add(r,an+jb,t.data(),t.size());
+          //Squaring: a[0..ia)*b[kb..bn) is the same
+          if(a==b) {
+               _cells_add(r,an+jb,t.data(),t.size());
+               return;
+          }
+     }
+     long ia=min(ka,last-kb);
+     if(kb<bn && ia>0) {
+          t.resize(ia+bn-kb);
+          _mul_high(a,ia,b+kb,bn-kb,t.data(),last-kb);
+          _cells_add(r,ia+bn,t.data(),t.size());
+     }
+}
+///Long squaring of a raw cell array, column by column like _mul_basecase(). The cross products a[i]*a[j] (i<j) of a column are summed once, normalized, and then doubled.
+template<typename S, typename A>
+void BigN<S,A>::_sqr_basecase(const S* a, long an, S* r)
+{
+     WideST carry=0;
+     for(long k=2*an-1; k>=0; --k) {
+          //The cross products of the column are those with i<j=k-1-i; their sum is hi*cshift+acc
+          WideST acc=0, hi=0;
+          long i=max(0L,k-an), iend=k/2;
+          while(i<iend) {
+               long stop=min(iend,i+column_block);
+               for(; i<stop; ++i)
+                    acc+=WideST(a[i])*a[k-1-i];
+               hi+=acc/cshift;
+               acc%=cshift;
+          }
+          acc=2*acc+carry;
+          if(k%2)
+               acc+=WideST(a[k/2])*a[k/2];
+          r[k]=acc%cshift;
+          carry=2*hi+acc/cshift;
+     }
+}
+///Multiplies a by a much shorter b (an>=2*bn) by cutting a into pieces of bn cells, so that each partial product is balanced
+template<typename S, typename A>
+void BigN<S,A>::_mul_unbalanced(const S* a, long an, const S* b, long bn, S* r)
+{
+     fill(r,r+an+bn,S(0));
+     Cells t(2*bn);
+     for(long hi=an; hi>0; hi-=bn) {
+          long lo=max(0L,hi-bn);
+          _mul_cells(a+lo,hi-lo,b,bn,t.data());
+          //The last cell of the piece a[lo..hi) is worth cshift^(an-hi)
+          _cells_add(r,hi+bn,t.data(),hi-lo+bn);
+     }
+}
+/**\brief Karatsuba multiplication of raw cell arrays (an>=bn>an/2).
 
-template<>
-inline short BigN<u8>::operator[](unsigned pos) const
+With a=a1*cshift^m+a0 and b=b1*cshift^m+b0, where a0 and b0 are the last m cells, the product is z2*cshift^(2m)+z1*cshift^m+z0,
+where z2=a1*b1, z0=a0*b0, and z1=(a1+a0)*(b1+b0)-z2-z0. That takes three half-sized multiplications instead of four.
+*/
+template<typename S, typename A>
+void BigN<S,A>::_mul_karatsuba(const S* a, long an, const S* b, long bn, S* r)
 {
-     return short(v_[pos]);
+     long m=an/2;
+     long rn=an+bn;
+     //z2 fills the first rn-2m cells of r and z0 the last 2m ones
+     _mul_cells(a,an-m,b,bn-m,r);
+     _mul_cells(a+an-m,m,b+bn-m,m,r+rn-2*m);
+
+     Cells sa(an-m+1,0), sb;
+     copy(a,a+an-m,sa.end()-(an-m));
+     _cells_add(sa.data(),sa.size(),a+an-m,m);
+     //Squaring: b's sum is a's
+     const S* psb=sa.data();
+     long sbn=sa.size();
+     if(a!=b) {
+          sb.assign(max(bn-m,m)+1,0);
+          copy(b,b+bn-m,sb.end()-(bn-m));
+          _cells_add(sb.data(),sb.size(),b+bn-m,m);
+          psb=sb.data();
+          sbn=sb.size();
+     }
+
+     Cells z1(sa.size()+sbn);
+     _mul_cells(sa.data(),sa.size(),psb,sbn,z1.data());
+     _cells_sub(z1.data(),z1.size(),r,rn-2*m);
+     _cells_sub(z1.data(),z1.size(),r+rn-2*m,2*m);
+
+     _cells_add_shifted(r,rn,z1.data(),z1.size(),m);
 }
+/**\brief Toom-Cook 3-way multiplication of raw cell arrays (an>=bn>an/2).
+
+The operands are cut into three pieces of k cells each and treated as polynomials in cshift^k.
+Their product polynomial w=r4*x^4+r3*x^3+r2*x^2+r1*x+r0 is found from five multiplications of about a third of the size: w(0), w(1), w(2), w(3), and w(inf)=r4.
+Having all the evaluation points nonnegative means that every intermediate value of the interpolation is a nonnegative combination of r0..r4, so the whole thing can be done on unsigned cells:
+\code
+u1=w(1)-r0-r4          =r1+r2+r3
+u2=(w(2)-r0-16*r4)/2   =r1+2*r2+4*r3
+u3=(w(3)-r0-81*r4)/3   =r1+3*r2+9*r3
+r3=((u3-u2)-(u2-u1))/2, r2=(u2-u1)-3*r3, r1=u1-r2-r3
+\endcode
+*/
+template<typename S, typename A>
+void BigN<S,A>::_mul_toom3(const S* a, long an, const S* b, long bn, S* r)
+{
+     long k=(an+2)/3;
+     long rn=an+bn;
+     long len=2*k+4;
+
+     Cells ea(k+2), eb(k+2);
+     Cells w0(len), w1(len), w2(len), w3(len), winf(len,0), t(len);
+     //Squaring: b's values are a's
+     S* peb= a==b ? ea.data() : eb.data();
+     S* w[4]= {w0.data(),w1.data(),w2.data(),w3.data()};
+     for(S pt=0; pt<4; ++pt) {
+          _toom3_eval(a,an,k,pt,ea.data());
+          if(a!=b)
+               _toom3_eval(b,bn,k,pt,eb.data());
+          _mul_cells(ea.data(),k+2,peb,k+2,w[pt]);
+     }
+     //The top pieces; b's may be empty
+     if(bn>2*k)
+          _mul_cells(a,an-2*k,b,bn-2*k,winf.data()+len-(an+bn-4*k));
+
+     //w1 -> u1
+     _cells_sub(w1.data(),len,w0.data(),len);
+     _cells_sub(w1.data(),len,winf.data(),len);
+     //w2 -> u2
+     t=winf;
+     _cells_mul1(t.data(),len,16);
+     _cells_sub(w2.data(),len,w0.data(),len);
+     _cells_sub(w2.data(),len,t.data(),len);
+     _cells_div1(w2.data(),len,2);
+     //w3 -> u3
+     t=winf;
+     _cells_mul1(t.data(),len,81);
+     _cells_sub(w3.data(),len,w0.data(),len);
+     _cells_sub(w3.data(),len,t.data(),len);
+     _cells_div1(w3.data(),len,3);
+     //w3 -> r3
+     _cells_sub(w3.data(),len,w2.data(),len);
+     _cells_sub(w2.data(),len,w1.data(),len);
+     _cells_sub(w3.data(),len,w2.data(),len);
+     _cells_div1(w3.data(),len,2);
+     //w2 -> r2
+     t=w3;
+     _cells_mul1(t.data(),len,3);
+     _cells_sub(w2.data(),len,t.data(),len);
+     //w1 -> r1
+     _cells_sub(w1.data(),len,w2.data(),len);
+     _cells_sub(w1.data(),len,w3.data(),len);
+
+     fill(r,r+rn,S(0));
+     _cells_add_shifted(r,rn,w0.data(),len,0);
+     _cells_add_shifted(r,rn,w1.data(),len,k);
+     _cells_add_shifted(r,rn,w2.data(),len,2*k);
+     _cells_add_shifted(r,rn,w3.data(),len,3*k);
+     _cells_add_shifted(r,rn,winf.data(),len,4*k);
+}
+///Packs the raw cell array x into base-ntt_base coefficients, least significant first; either ntt_cells cells make a coefficient, or a cell makes ntt_split of them
+template<typename S, typename A>
+void BigN<S,A>::_ntt_pack(const S* x, long xn, vector<u32>& c)
+{
+     if(ntt_split>1) {
+          c.resize(xn*ntt_split);
+          for(long i=xn-1, j=0; i>=0; --i)
+               for(S cell=x[i], k=0; k<ntt_split; ++k, cell/=ntt_base)
+                    c[j++]=cell%ntt_base;
+          return;
+     }
+     c.assign((xn+ntt_cells-1)/ntt_cells,0);
+     for(long j=0, hi=xn; hi>0; ++j, hi-=ntt_cells)
+          for(long i=max(hi-ntt_cells,0L); i<hi; ++i)
+               c[j]=c[j]*cshift+x[i];
+}
+/**\brief Multiplies raw cell arrays by means of number-theoretic transforms (see ntt_multiply()).
+\return false if the operands are too long for the transforms or if the compiler has no 128-bit integers; r is left untouched then.
+*/
+template<typename S, typename A>
+bool BigN<S,A>::_mul_ntt(const S* a, long an, const S* b, long bn, S* r)
+{
+#ifdef __SIZEOF_INT128__
+     vector<u32> ca, cb, cr;
+     _ntt_pack(a,an,ca);
+     if(a!=b)
+          _ntt_pack(b,bn,cb);
+     //Passing ca twice makes the transforms square
+     if(!ntt_multiply(ca,a==b ? ca : cb,ntt_base,cr))
+          return false;
+     cr.resize((an+bn)*ntt_split,0);
+     if(ntt_split>1) {
+          for(long i=an+bn-1, j=0; i>=0; --i) {
+               S cell=0;
+               for(long k=ntt_split-1; k>=0; --k)
+                    cell=cell*ntt_base+cr[j+k];
+               j+=ntt_split;
+               r[i]=cell;
+          }
+          return true;
+     }
+     long k=0;
+     for(long hi=an+bn; hi>0; ++k, hi-=ntt_cells) {
+          u32 c= k<long(cr.size()) ? cr[k] : 0;
+          for(long i=hi-1; i>=max(hi-ntt_cells,0L); --i) {
+               r[i]=c%cshift;
+               c/=cshift;
+          }
+     }
+     return true;
+#else
+     return false;
+#endif
+}
+///Evaluates x, cut into pieces x2, x1, x0 of k cells each (counting from the end; x2 may be shorter or empty), as x2*t^2+x1*t+x0, writing the k+2 cells of the result into e
+template<typename S, typename A>
+void BigN<S,A>::_toom3_eval(const S* x, long xn, long k, S t, S* e)
+{
+     long b1=max(xn-2*k,0L), b0=max(xn-k,0L);
+     fill(e,e+k+2,S(0));
+     copy(x,x+b1,e+k+2-b1);
+     _cells_mul1(e,k+2,t);
+     _cells_add(e,k+2,x+b1,b0-b1);
+     _cells_mul1(e,k+2,t);
+     _cells_add(e,k+2,x+b0,xn-b0);
+}
+
+template<typename S, typename A>
+long BigN<S,A>::div_scale=DIV_SCALE;
+template<typename S, typename A>
+long BigN<S,A>::mul_scale=-1;
+template<typename S, typename A>
+round_mode BigN<S,A>::rounding=ROUND_DOWN;
+
+/**\brief Divides x by y, truncating the quotient (toward zero) to *scale* digits behind the decimal point.
+
+With x=xi*10^-x.scale_ and y=yi*10^-y.scale_, where xi and yi are the integers that the cells since beg_ represent,
+the quotient times 10^scale is xi*10^(scale-x.scale_+y.scale_)/yi, which is then an integer division of raw cells.
+The remainder of that division, scaled back, is x-q*y; it has the sign of x.
+\param [out] q The quotient, unless NULL
+\param [out] r The remainder, unless NULL. Either may alias x or y, but not each other.
+*/
+template<typename S, typename A>
+void BigN<S,A>::_divmod(const BigN<S,A>& x, const BigN<S,A>& y, long scale, BigN<S,A>* q, BigN<S,A>* r)
+{
+     if(!y)
+          throw exDivByZero();
+     long e=scale-x.scale_+y.scale_;
+     Cells u(x.v_.begin()+x.beg_,x.v_.end()), v(y.v_.begin()+y.beg_,y.v_.end()), qc, rc;
+     if(e>=0)
+          _cells_shift10(u,e);
+     else
+          _cells_shift10(v,-e);
+     _divmod_cells(u.data(),u.size(),v.data(),v.size(),qc,rc);
+
+     esign rsign=x.sign_, qsign= x.sign_==y.sign_ ? PLUS : MINUS;
+     long rscale= e>=0 ? scale+y.scale_ : x.scale_;
+     if(r)
+          r->_assign_cells(rc,rscale,rsign);
+     if(q)
+          q->_assign_cells(qc,scale,qsign);
+}
+///Takes over the raw cells c (swapping them in) as the number c*10^-scale with the given sign
+template<typename S, typename A>
+void BigN<S,A>::_assign_cells(Cells& c, long scale, esign sign)
+{
+     if(!_cells_cmp(c.data(),c.size(),NULL,0)) {
+          *this=0;
+          return;
+     }
+     v_.assign(c.begin(),c.end());
+     beg_=0;
+     scale_=scale;
+     sign_=sign;
+     _trim();
+}
+///The magnitude of the integral part, or ~u64(0) if it doesn't fit in a u64
+template<typename S, typename A>
+u64 BigN<S,A>::_int_part_abs() const
+{
+     const S* x=v_.data();
+     long u=v_.size()-1, fd=0;
+     if(scale_>0) {
+          u-=scale_/cshift10d;
+          fd=scale_%cshift10d;
+     }
+     const u64 lim=~u64(0);
+     u64 r=0;
+     for(long i=beg_; i<=u; ++i) {
+          u64 c= i<u ? x[i] : x[i]/pten[fd], base= i<u ? u64(cshift) : pten[cshift10d-fd];
+          if(r>(lim-c)/base)
+               return lim;
+          r=r*base+c;
+     }
+     for(long i=scale_; i<0; ++i) {
+          if(r>lim/10)
+               return lim;
+          r*=10;
+     }
+     return r;
+}
+/** \brief Rounds to the nearest F, ties to even.
+The magnitude is multiplied by a power of two 2^s (see _times_pow2()), such that the integral part holds the mantissa and at least one bit more to round by; the fractional part only tells whether anything is left behind that bit.
+Only the first 40 or so digits are scaled, unless the scaled fraction gets so close to 1 that the digits cut off could carry into the integral part.
+*/
+template<typename S, typename A>
+template<typename F>
+F BigN<S,A>::_to_native(false_type) const
+{
+     const int p=numeric_limits<F>::digits;
+     static_assert(p<=56, "The mantissa and the bits to round it by must fit in a u64.");
+     const F sign= sign_==MINUS ? -1 : 1;
+     if(!*this)
+          return sign*0;
+     //10^(d-1) <= |*this| < 10^d
+     long d=long(v_.size())*cshift10d-(beg_*cshift10d+_c_beg_padding(beg_))-scale_;
+     if(d-1>numeric_limits<F>::max_exponent10)
+          return sign*numeric_limits<F>::infinity();
+     if(d<numeric_limits<F>::min_exponent10-numeric_limits<F>::digits10-3)
+          return sign*0;
+     //2^(p+1) < |*this|*2^s < 2^(p+7)
+     long s=p+6-long(ceil(d*3.321928094887362));
+     const long keep=40/cshift10d+2;
+     BigN t;
+     bool cut;
+     for(long n= min(keep,_cells_since_beg()); ; n=_cells_since_beg()) {
+          t.v_.assign(v_.begin()+beg_,v_.begin()+beg_+n);
+          t.beg_=0;
+          t.scale_=scale_-(_cells_since_beg()-n)*cshift10d;
+          t.sign_=PLUS;
+          t._times_pow2(s);
+          cut=false;
+          for(long i=beg_+n; i<(long)v_.size() && !cut; ++i)
+               cut= v_[i]!=0;
+          //The cut off digits add less than 10^-20 to the scaled number
+          long f=long(t.v_.size())*cshift10d-t.scale_;
+          bool nines= cut && t.scale_>=20 && f>=0;
+          for(digit_iterator it=t.digit_at(max(f,0L)); nines && it.pos()<f+20; ++it)
+               nines= *it==9;
+          if(!nines)
+               break;
+     }
+     u64 q=t._int_part_abs();
+     bool sticky= cut || (t.scale_>0 && long(t._v_end_zs())<t.scale_);
+     long b=0;
+     for(u64 r=q; r; r>>=1)
+          ++b;
+     //The weight of the last bit of the mantissa, which subnormals have fewer of
+     long L=max<long>(b-1-s-(p-1),numeric_limits<F>::min_exponent-p), sh=L+s;
+     if(sh>=64)
+          return sign*0;
+     u64 m=q>>sh;
+     if((q>>(sh-1))&1 && (sticky || q&((u64(1)<<(sh-1))-1) || m&1))
+          ++m;
+     return sign*ldexp(F(m),int(L));
+}
+///Compares raw cell arrays, which may have leading zero cells
+///\return a value >0 if a>b, 0 if a==b, and a value <0 if a<b
+template<typename S, typename A>
+int BigN<S,A>::_cells_cmp(const S* a, long an, const S* b, long bn)
+{
+     for(; an && !*a; --an, ++a)
+          ;;
+     for(; bn && !*b; --bn, ++b)
+          ;;
+     if(an!=bn)
+          return an>bn ? 1 : -1;
+     for(long i=0; i<an; ++i)
+          if(a[i]!=b[i])
+               return a[i]>b[i] ? 1 : -1;
+     return 0;
+}
+///Multiplies the raw cell array x by 10^e (e>=0), growing it as needed
+template<typename S, typename A>
+void BigN<S,A>::_cells_shift10(Cells& x, long e)
+{
+     x.resize(x.size()+e/cshift10d,0);
+     if(e%cshift10d) {
+          x.insert(x.begin(),0);
+          _cells_mul1(x.data(),x.size(),pten[e%cshift10d]);
+     }
+}
+/**\brief Integer division of raw cells by Knuth's algorithm D (The Art of Computer Programming, vol. 2, 4.3.1).
+
+Divides u (un cells) by v (vn>=2 cells, v[0]!=0, un>=vn), writing the un-vn+1 cells of the quotient into q and the vn cells of the remainder into r.
+Both are first multiplied by d=cshift/(v[0]+1), which makes the first cell of the divisor at least cshift/2, so that each quotient cell guessed from the first cells is at most two too high.
+*/
+template<typename S, typename A>
+void BigN<S,A>::_div_knuth(const S* u, long un, const S* v, long vn, S* q, S* r)
+{
+     Cells nu(un+1,0), nv(v,v+vn);
+     copy(u,u+un,nu.begin()+1);
+     _div_knuth_scratch(nu.data(),un,nv.data(),vn,q,r);
+}
+///_div_knuth() on cells the caller provides: nu holds a zero cell followed by the un cells of the dividend, and nv the vn cells of the divisor; both are overwritten
+template<typename S, typename A>
+void BigN<S,A>::_div_knuth_scratch(S* nu, long un, S* nv, long vn, S* q, S* r)
+{
+     S d=cshift/(nv[0]+1);
+     _cells_mul1(nu,un+1,d);
+     _cells_mul1(nv,vn,d);
+     WideST v1=nv[0], v2=nv[1];
+
+     for(long j=0; j<=un-vn; ++j) {
+          //The current window of the remainder is w[0..vn]
+          S* w=&nu[j];
+          WideST num=WideST(w[0])*cshift+w[1];
+          WideST qhat=num/v1, rhat=num%v1;
+          while(qhat>=WideST(cshift) || qhat*v2>rhat*cshift+w[2]) {
+               --qhat;
+               rhat+=v1;
+               if(rhat>=WideST(cshift))
+                    break;
+          }
+          //w-=qhat*nv
+          WideST carry=0;
+          S borrow=0;
+          for(long i=vn-1; i>=0; --i) {
+               WideST p=qhat*nv[i]+carry;
+               carry=p/cshift;
+               S sub=S(p%cshift)+borrow;
+               if(sub>w[i+1]) {
+                    w[i+1]=w[i+1]+cshift-sub;
+                    borrow=1;
+               } else {
+                    w[i+1]-=sub;
+                    borrow=0;
+               }
+          }
+          S sub=S(carry)+borrow;
+          if(sub>w[0]) {
+               //qhat was one too high; add nv back (the carry out cancels the wrap-around)
+               w[0]=w[0]+cshift-sub;
+               --qhat;
+               _cells_add(w,vn+1,nv,vn);
+          } else
+               w[0]-=sub;
+          q[j]=S(qhat);
+     }
+     copy(nu+un+1-vn,nu+un+1,r);
+     _cells_div1(r,vn,d);
+}
+/**\brief Approximate reciprocal of raw cells by Newton's iteration (Brent & Zimmermann: Modern Computer Arithmetic, algorithm 3.5).
+
+For a (n cells, a[0]>=cshift/2) computes the n+1 cells of x such that a*x < cshift^(2n) <= a*(x+2).
+The reciprocal of the first half of a is computed recursively and then refined with one Newton step, x=xh+xh*(cshift^(n+h)-a*xh) (properly shifted),
+so the total cost is a few multiplications of n cells.
+*/
+template<typename S, typename A>
+void BigN<S,A>::_recip(const S* a, long n, Cells& x)
+{
+     x.assign(n+1,0);
+     if(n<div_newton_threshold) {
+          //x=ceil(cshift^(2n)/a)-1=floor((cshift^(2n)-1)/a)
+          Cells num(2*n,cshift-1), rem(n);
+          if(n==1) {
+               copy(num.begin(),num.end(),x.begin());
+               _cells_div1(x.data(),2,a[0]);
+          } else
+               _div_knuth(num.data(),2*n,a,n,x.data(),rem.data());
+          return;
+     }
+     long l=(n-1)/2, h=n-l;
+     Cells xh;
+     _recip(a,h,xh);
+
+     Cells t(n+h+1);
+     _mul_cells(a,n,xh.data(),h+1,t.data());
+     const S one=1;
+     while(t[0]) {
+          _cells_sub(xh.data(),h+1,&one,1);
+          _cells_sub(t.data(),n+h+1,a,n);
+     }
+     //t=cshift^(n+h)-t (as n+h cells, the borrow out being the cshift^(n+h))
+     Cells tc(n+h,0);
+     _cells_sub(tc.data(),n+h,t.data()+1,n+h);
+
+     //u=floor(tc/cshift^l)*xh, x=xh*cshift^l+floor(u/cshift^(2h-l))
+     Cells u(3*h+1);
+     _mul_cells(tc.data(),2*h,xh.data(),h+1,u.data());
+     copy(xh.begin(),xh.end(),x.begin());
+     _cells_add(x.data(),n+1,u.data(),n+1);
+}
+/**\brief Integer division of raw cells with a Newton reciprocal.
+
+Divides u (un cells) by v (vn cells, v[0]!=0) like _div_knuth(), but in a few multiplications' time.
+After the normalization of _div_knuth(), both are shifted left by whole cells until the dividend is at most twice as long as the divisor.
+The quotient is then the first cells of u*recip(v), which is at most a few units too low, and is fixed up with the remainder.
+*/
+template<typename S, typename A>
+void BigN<S,A>::_div_newton(const S* u, long un, const S* v, long vn, Cells& q, Cells& r)
+{
+     S d=cshift/(v[0]+1);
+     Cells nu(un+1,0), nv(v,v+vn);
+     copy(u,u+un,nu.begin()+1);
+     _cells_mul1(nu.data(),un+1,d);
+     _cells_mul1(nv.data(),vn,d);
+     if(!nu[0])
+          nu.erase(nu.begin());
+     long k=max(long(nu.size())-2*vn,0L);
+     nu.resize(nu.size()+k,0);
+     nv.resize(vn+k,0);
+     long m=nu.size(), n=nv.size();
+
+     Cells x, p(m+n+1);
+     _recip(nv.data(),n,x);
+     _mul_cells(nu.data(),m,x.data(),n+1,p.data());
+     q.assign(p.begin(),p.end()-2*n);
+
+     //r=nu-q*nv
+     Cells qv(q.size()+n);
+     _mul_cells(q.data(),q.size(),nv.data(),n,qv.data());
+     r.assign(qv.size()-m,0);
+     r.insert(r.end(),nu.begin(),nu.end());
+     _cells_sub(r.data(),r.size(),qv.data(),qv.size());
+     const S one=1;
+     while(_cells_cmp(r.data(),r.size(),nv.data(),n)>=0) {
+          _cells_sub(r.data(),r.size(),nv.data(),n);
+          _cells_add(q.data(),q.size(),&one,1);
+     }
+     r.erase(r.begin(),r.end()-n);
+     r.resize(n-k);
+     _cells_div1(r.data(),r.size(),d);
+}
+/**\brief Integer division of raw cells: q=u/v, r=u%v.
+
+Single-cell divisors are handled by _cells_div1(), short divisors or short quotients by Knuth's algorithm D,
+and divisors and quotients that are both at least BigN::div_newton_threshold long by a Newton reciprocal.
+\note v must not be zero.
+*/
+template<typename S, typename A>
+void BigN<S,A>::_divmod_cells(const S* u, long un, const S* v, long vn, Cells& q, Cells& r)
+{
+     for(; un && !*u; --un, ++u)
+          ;;
+     for(; vn && !*v; --vn, ++v)
+          ;;
+     if(un<vn) {
+          q.assign(1,0);
+          r.assign(u,u+un);
+          if(r.empty())
+               r.push_back(0);
+     } else if(vn==1) {
+          q.assign(u,u+un);
+          r.assign(1,_cells_div1(q.data(),un,v[0]));
+     } else if(min(vn,un-vn+1)<div_newton_threshold) {
+          q.resize(un-vn+1);
+          r.resize(vn);
+          _div_knuth(u,un,v,vn,q.data(),r.data());
+     } else
+          _div_newton(u,un,v,vn,q,r);
+}
+
 
 ///Prints debugging information about a BigN
-template<typename S>
-void BigN<S>::printinfo(ostream& os) const
+template<typename S, typename A>
+void BigN<S,A>::printinfo(ostream& os) const
          	 {
          		  if(sign_==MINUS)
          			   os<<"-"<<endl;
          		  for(auto it=v_.begin(); it!=v_.end(); ++it) {
-         			   os<<setw(cshift10d)<<setfill('0')<<*it<<endl;
+         			   os<<setw(cshift10d)<<setfill('0')<<u64(*it)<<endl;
          		  }
          		  os<<"beg_="<<beg_<<endl;
          		  os<<"scale_="<<scale_<<endl;
@@ -792,20 +1402,6 @@ void BigN<S>::printinfo(ostream& os) const
 
          	 }
 
-template<>
-void BigN<u8>::printinfo(ostream& os) const
-{
-     if(sign_==MINUS)
-          os<<"-"<<endl;
-     for(auto it=v_.begin(); it!=v_.end(); ++it) {
-          os.put('0'+*it)<<endl;
-     }
-     os<<"beg_="<<beg_<<endl;
-     os<<"scale_="<<scale_<<endl;
-     os<<"length="<<v_.size()<<endl;
-
-}
-
 
 }
 #endif /* BIGN__HPP_ */
@@ -0,0 +1,208 @@
+#ifndef BIGN_ARENA_HPP_
+#define BIGN_ARENA_HPP_
+#include <vector>
+#include <memory>
+#include <new>
+#include <cstdlib>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#ifndef ARENA_BLOCK_BYTES
+///Size of the blocks that a CellArena hands out memory from; larger requests get blocks of their own. Override with -DARENA_BLOCK_BYTES=n
+#define ARENA_BLOCK_BYTES (1L<<20)
+#endif
+#ifndef ARENA_HUGE_BYTES
+///Blocks from this size on are mapped from huge pages (on Linux, where there are any; otherwise transparent huge pages are asked for). Override with -DARENA_HUGE_BYTES=n
+#define ARENA_HUGE_BYTES (2L<<20)
+#endif
+
+/**
+ * \file
+ * \brief A Bump Allocator for Cells.
+ * Evaluating a Calculator statement creates and destroys lots of temporary BigN's. With ArenaAllocator, their cells come from a CellArena, which hands out memory by bumping a pointer and takes all of it back at once, when reset() at the end of the statement.
+ */
+
+namespace BigNum {
+using namespace std;
+
+/**\brief Hands out 64-byte-aligned memory from large blocks by bumping a pointer, and takes it all back at once in reset().
+Freeing single allocations is a no-op. The blocks are kept for the next round (except for oversized ones), so once warmed up, an arena doesn't touch the global heap.
+ArenaAllocator allocates from the arena made active by a Scope.
+*/
+class CellArena {
+     struct Block {
+          char* raw;   ///<What was allocated
+          char* p;     ///<Its first 64-byte-aligned byte
+          size_t size; ///<Usable bytes from p on
+          bool mapped; ///<Whether raw was mmap'ed rather than new'ed
+     };
+     vector<Block> blocks_;
+     size_t cur_;       ///<The block being handed out from
+     char* top_;        ///<Its first free byte
+     CellArena* next_;  ///<The next one in the list of all arenas, which owner() searches
+
+     static CellArena*& _active() {
+          static CellArena* a=0;
+          return a;
+     }
+     static CellArena*& _all() {
+          static CellArena* a=0;
+          return a;
+     }
+     static Block _new_block(size_t size) {
+          Block b;
+#if defined(__linux__)
+          if(size>=size_t(ARENA_HUGE_BYTES)) {
+               size=(size+ARENA_HUGE_BYTES-1)/ARENA_HUGE_BYTES*ARENA_HUGE_BYTES;
+               void* m=mmap(0,size,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB,-1,0);
+               if(m==MAP_FAILED) {
+                    m=mmap(0,size,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+                    if(m==MAP_FAILED)
+                         throw bad_alloc();
+                    madvise(m,size,MADV_HUGEPAGE);
+               }
+               b.raw=b.p=static_cast<char*>(m);
+               b.size=size;
+               b.mapped=true;
+               return b;
+          }
+#endif
+          b.raw=static_cast<char*>(::operator new(size+align));
+          b.p=b.raw+(align-size_t(b.raw)%align)%align;
+          b.size=size;
+          b.mapped=false;
+          return b;
+     }
+     static void _delete_block(const Block& b) {
+#if defined(__linux__)
+          if(b.mapped) {
+               munmap(b.raw,b.size);
+               return;
+          }
+#endif
+          ::operator delete(b.raw);
+     }
+     CellArena(const CellArena&);
+     CellArena& operator=(const CellArena&);
+public:
+     enum { align=64 };
+
+     CellArena() : cur_(0), top_(0), next_(_all()) {
+          _all()=this;
+     }
+     ~CellArena() {
+          for(CellArena** a=&_all(); *a; a=&(*a)->next_)
+               if(*a==this) {
+                    *a=next_;
+                    break;
+               }
+          for(size_t i=0; i<blocks_.size(); ++i)
+               _delete_block(blocks_[i]);
+     }
+     ///\return bytes (rounded up to a multiple of 64) of 64-byte-aligned memory
+     void* allocate(size_t bytes) {
+          bytes=(bytes+align-1)/align*align;
+          while(cur_<blocks_.size() && size_t(blocks_[cur_].p+blocks_[cur_].size-top_)<bytes)
+               if(++cur_<blocks_.size())
+                    top_=blocks_[cur_].p;
+          if(cur_==blocks_.size()) {
+               blocks_.push_back(_new_block(max<size_t>(bytes,ARENA_BLOCK_BYTES)));
+               top_=blocks_[cur_].p;
+          }
+          void* r=top_;
+          top_+=bytes;
+          return r;
+     }
+     ///Whether p was handed out by this arena
+     bool owns(const void* p) const {
+          for(size_t i=0; i<blocks_.size(); ++i)
+               if(p>=blocks_[i].p && p<blocks_[i].p+blocks_[i].size)
+                    return true;
+          return false;
+     }
+     ///Takes back all of the memory handed out; blocks of the standard size are kept for reuse, oversized ones are freed
+     void reset() {
+          size_t n=0;
+          for(size_t i=0; i<blocks_.size(); ++i)
+               if(blocks_[i].size>size_t(ARENA_BLOCK_BYTES))
+                    _delete_block(blocks_[i]);
+               else
+                    blocks_[n++]=blocks_[i];
+          blocks_.resize(n);
+          cur_=0;
+          top_= n ? blocks_[0].p : 0;
+     }
+
+     ///The arena that ArenaAllocators allocate from; 0 if none
+     static CellArena* active() {
+          return _active();
+     }
+     ///The arena that handed out p, searching the blocks of all of them; 0 if none did
+     static CellArena* owner(const void* p) {
+          for(CellArena* a=_all(); a; a=a->next_)
+               if(a->owns(p))
+                    return a;
+          return 0;
+     }
+     ///Makes an arena (or none, if 0) the one that ArenaAllocators allocate from, until the Scope ends
+     class Scope {
+          CellArena* prev_;
+     public:
+          explicit Scope(CellArena* a) : prev_(_active()) {
+               _active()=a;
+          }
+          ~Scope() {
+               _active()=prev_;
+          }
+     };
+};
+
+/**\brief Allocates from the active CellArena, or from the heap when there is none.
+Every allocation is preceded by a header naming the arena it came from (0 for the heap), so deallocate() and arena_of() don't have to search the arenas.
+Deallocation frees memory only if it came from the heap, so allocations may outlive the scope they were made in, but not the reset of their arena.
+*/
+template<typename T>
+struct ArenaAllocator {
+     typedef T value_type;
+     template<typename U> struct rebind {
+          typedef ArenaAllocator<U> other;
+     };
+     ///Bytes in front of an allocation; keeps the alignment of operator new
+     enum { header=2*sizeof(void*) };
+     ArenaAllocator() {}
+     template<typename U> ArenaAllocator(const ArenaAllocator<U>&) {}
+
+     T* allocate(size_t n) {
+          CellArena* a=CellArena::active();
+          char* h=static_cast<char*>(a ? a->allocate(header+n*sizeof(T)) : ::operator new(header+n*sizeof(T)));
+          *reinterpret_cast<CellArena**>(h)=a;
+          return reinterpret_cast<T*>(h+header);
+     }
+     void deallocate(T* p, size_t) {
+          if(!arena_of(p))
+               ::operator delete(reinterpret_cast<char*>(p)-header);
+     }
+     ///The arena that p (allocated by an ArenaAllocator) came from; 0 if it came from the heap
+     static CellArena* arena_of(const void* p) {
+          return *reinterpret_cast<CellArena* const*>(static_cast<const char*>(p)-header);
+     }
+     bool operator==(const ArenaAllocator&) const { return true; }
+     bool operator!=(const ArenaAllocator&) const { return false; }
+};
+///The arena that an allocator of type A handed p out from; only ArenaAllocators use arenas
+template<typename A>
+inline CellArena* arena_of(const A&, const void*) {
+     return 0;
+}
+template<typename T>
+inline CellArena* arena_of(const ArenaAllocator<T>&, const void* p) {
+     return ArenaAllocator<T>::arena_of(p);
+}
+
+///Moves x's storage out of any CellArena, so that it survives the arena's reset; for types that don't allocate from one, this does nothing
+template<typename T>
+inline void leave_arena(T&) {}
+
+}//namespace BigNum
+#endif /* BIGN_ARENA_HPP_ */
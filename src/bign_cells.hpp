@@ -0,0 +1,216 @@
+#ifndef BIGN_CELLS_HPP_
+#define BIGN_CELLS_HPP_
+#include <memory>
+#include <algorithm>
+#include <cstring>
+
+#include "bign_arena.hpp"
+
+#ifndef INLINE_CELL_BYTES
+///Bytes of cells that a BigN stores inside itself, only allocating cells on the heap when it outgrows them. Override with -DINLINE_CELL_BYTES=n
+#define INLINE_CELL_BYTES 32
+#endif
+
+/**
+ * \file
+ * \brief Cell Storage.
+ * BigN stores its cells most significant first, and carries out of the first cell, as well as left trims, happen at the front. A vector would shift all of the cells for them, so BigN keeps its cells in a CellStore instead.
+ */
+
+namespace BigNum {
+using namespace std;
+
+/**\brief A vector of cells with headroom at both ends, and room for a few cells inline.
+Inserting at the front uses free cells before the first one (reserving more than it needs when it has to reallocate, just like push_back() does at the end), and erasing at the front only moves the first cell pointer, so neither moves the cells in between.
+Up to nlocal cells are kept in local_, so small numbers never allocate; the cells move to the heap once they outgrow it, and stay there.
+Provides the subset of std::vector that BigN uses, with plain pointers for iterators.
+ \tparam S The (trivially copyable) cell type.
+ \tparam A The allocator of the heap cells.
+ */
+template<typename S, typename A=allocator<S> >
+class CellStore {
+     enum { nlocal=INLINE_CELL_BYTES/sizeof(S) ? INLINE_CELL_BYTES/sizeof(S) : 1 };
+     S* buf_; ///<The allocation (local_, unless the cells have outgrown it)
+     S* b_;   ///<The first cell
+     S* e_;   ///<Past the last cell
+     S* cap_; ///<Past the allocation
+     S local_[nlocal];
+
+     ///Makes sure that there are at least front free cells before b_ and back after e_, reallocating with extra headroom where there aren't
+     void _make_room(size_t front, size_t back) {
+          size_t hf=b_-buf_, hb=cap_-e_;
+          if(hf>=front && hb>=back)
+               return;
+          size_t n=size();
+          //Within local_, the cells are just moved to make room
+          if(buf_==local_ && front+n+back<=size_t(nlocal)) {
+               memmove(local_+front,b_,n*sizeof(S));
+               b_=local_+front;
+               e_=b_+n;
+               return;
+          }
+          //Headroom that is kept (rather than asked for) is capped, so that a store whose cells drift toward one end doesn't grow without bound
+          hf= hf<front ? front+n/2+4 : min(hf,n/2+4);
+          hb= hb<back ? back+n+4 : min(hb,n+4);
+          S* nbuf=A().allocate(hf+n+hb);
+          if(n)
+               memcpy(nbuf+hf,b_,n*sizeof(S));
+          _free();
+          buf_=nbuf;
+          b_=buf_+hf;
+          e_=b_+n;
+          cap_=e_+hb;
+     }
+     void _free() {
+          if(buf_!=local_)
+               A().deallocate(buf_,cap_-buf_);
+     }
+     void _reset() {
+          buf_=b_=e_=local_;
+          cap_=local_+nlocal;
+     }
+public:
+     typedef S value_type;
+     typedef S* iterator;
+     typedef const S* const_iterator;
+     typedef size_t size_type;
+
+     CellStore() {
+          _reset();
+     }
+     explicit CellStore(size_t n, S x=S()) {
+          _reset();
+          resize(n,x);
+     }
+     template<typename It>
+     CellStore(It first, It last) {
+          _reset();
+          assign(first,last);
+     }
+     ///Copies only the cells, not the headroom
+     CellStore(const CellStore& y) {
+          _reset();
+          assign(y.begin(),y.end());
+     }
+     ///Takes over y's heap cells, or copies its inline ones
+     CellStore(CellStore&& y) {
+          _reset();
+          *this=move(y);
+     }
+     CellStore& operator=(const CellStore& y) {
+          if(this!=&y)
+               assign(y.begin(),y.end());
+          return *this;
+     }
+     CellStore& operator=(CellStore&& y) {
+          if(this==&y)
+               return *this;
+          if(y.buf_==y.local_) {
+               assign(y.begin(),y.end());
+               y.clear();
+               return *this;
+          }
+          _free();
+          buf_=y.buf_;
+          b_=y.b_;
+          e_=y.e_;
+          cap_=y.cap_;
+          y._reset();
+          return *this;
+     }
+     ~CellStore() {
+          _free();
+     }
+     void swap(CellStore& y) {
+          CellStore t(move(y));
+          y=move(*this);
+          *this=move(t);
+     }
+
+     size_t size() const { return e_-b_; }
+     bool empty() const { return e_==b_; }
+     S* data() { return b_; }
+     const S* data() const { return b_; }
+     S* begin() { return b_; }
+     const S* begin() const { return b_; }
+     S* end() { return e_; }
+     const S* end() const { return e_; }
+     S& operator[](size_t i) { return b_[i]; }
+     const S& operator[](size_t i) const { return b_[i]; }
+     S& back() { return e_[-1]; }
+     const S& back() const { return e_[-1]; }
+
+     ///Whether the cells were allocated from a CellArena
+     bool in_arena() const {
+          return buf_!=local_ && arena_of(A(),buf_);
+     }
+     ///Moves the cells to an allocation of just their size (or into local_), dropping the headroom
+     void shrink_to_fit() {
+          if(buf_==local_)
+               return;
+          CellStore t(begin(),end());
+          swap(t);
+     }
+     ///Keeps whatever headroom there is at the front, so that the cells can be rebuilt where they were
+     void clear() { e_=b_; }
+     void reserve(size_t n) {
+          if(n>size())
+               _make_room(0,n-size());
+     }
+     template<typename It>
+     void assign(It first, It last) {
+          size_t n=distance(first,last);
+          if(size_t(cap_-buf_)<n) {
+               _free();
+               _reset();
+               _make_room(0,n);
+          }
+          if(size_t(cap_-b_)<n)
+               b_=buf_;
+          e_=copy(first,last,b_);
+     }
+     void resize(size_t n, S x=S()) {
+          if(n>size()) {
+               _make_room(0,n-size());
+               fill(e_,b_+n,x);
+          }
+          e_=b_+n;
+     }
+     void push_back(S x) {
+          if(e_==cap_)
+               _make_room(0,1);
+          *e_++=x;
+     }
+     ///Inserts n cells x before pos; at the front, only reallocates when the headroom runs out
+     S* insert(S* pos, size_t n, S x) {
+          size_t i=pos-b_;
+          if(!i) {
+               _make_room(n,0);
+               b_-=n;
+               fill(b_,b_+n,x);
+               return b_;
+          }
+          _make_room(0,n);
+          pos=b_+i;
+          memmove(pos+n,pos,(e_-pos)*sizeof(S));
+          fill(pos,pos+n,x);
+          e_+=n;
+          return pos;
+     }
+     S* insert(S* pos, S x) {
+          return insert(pos,1,x);
+     }
+     ///Erases [first,last); at either end, that only moves b_ or e_
+     S* erase(S* first, S* last) {
+          if(first==b_) {
+               b_=last;
+               return b_;
+          }
+          memmove(first,last,(e_-last)*sizeof(S));
+          e_-=last-first;
+          return first;
+     }
+};
+
+}//namespace BigNum
+#endif /* BIGN_CELLS_HPP_ */
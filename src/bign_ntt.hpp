@@ -0,0 +1,140 @@
+#ifndef BIGN_NTT_HPP_
+#define BIGN_NTT_HPP_
+#include <vector>
+#include <algorithm>
+
+#include "bign_supplemental.hpp"
+
+/**
+ * \file
+ * \brief Number-Theoretic Transforms.
+ * Used by BigN to multiply very long numbers: the operands are convolved modulo three NTT-friendly primes and the exact convolution is recovered by the Chinese remainder theorem.
+ */
+
+namespace BigNum {
+using namespace std;
+
+/**\brief Number-theoretic transform modulo the prime P=c*2^k+1 with a primitive root G.
+ \tparam P A prime below 2^30 (so that a sum of two residues fits in an u32).
+ \tparam G A primitive root modulo P.
+ */
+template<u32 P, u32 G>
+struct NTT {
+     ///The longest transform P allows, i.e. the largest power of two dividing P-1
+     static size_t max_len() {
+          return (P-1)&~(P-2);
+     }
+     static u32 mul(u32 a, u32 b) {
+          return u32(u64(a)*b%P);
+     }
+     static u32 pow(u32 b, u32 e) {
+          u32 r=1;
+          for(; e; e>>=1, b=mul(b,b))
+               if(e&1)
+                    r=mul(r,b);
+          return r;
+     }
+     ///In-place transform of n (a power of two) residues; the inverse transform includes the division by n
+     static void transform(u32* a, size_t n, bool inverse) {
+          for(size_t i=1, j=0; i<n; ++i) {
+               size_t bit=n>>1;
+               for(; j&bit; bit>>=1)
+                    j^=bit;
+               j|=bit;
+               if(i<j)
+                    swap(a[i],a[j]);
+          }
+          vector<u32> w(n/2+1);
+          for(size_t len=2; len<=n; len<<=1) {
+               size_t half=len/2;
+               u32 wlen=pow(G,(P-1)/len);
+               if(inverse)
+                    wlen=pow(wlen,P-2);
+               w[0]=1;
+               for(size_t j=1; j<half; ++j)
+                    w[j]=mul(w[j-1],wlen);
+               for(size_t i=0; i<n; i+=len)
+                    for(size_t j=0; j<half; ++j) {
+                         u32 u=a[i+j], v=mul(a[i+j+half],w[j]);
+                         a[i+j]= u+v<P ? u+v : u+v-P;
+                         a[i+j+half]= u>=v ? u-v : u+P-v;
+                    }
+          }
+          if(inverse) {
+               u32 ninv=pow(u32(n%P),P-2);
+               for(size_t i=0; i<n; ++i)
+                    a[i]=mul(a[i],ninv);
+          }
+     }
+     ///Cyclic convolution of length n (a power of two) of the coefficient vectors a and b, modulo P; if a and b are the same vector, it is transformed only once
+     static void convolve(const vector<u32>& a, const vector<u32>& b, size_t n, vector<u32>& r) {
+          r.assign(n,0);
+          for(size_t i=0; i<a.size(); ++i)
+               r[i]=a[i]%P;
+          transform(r.data(),n,false);
+          if(&a==&b) {
+               for(size_t i=0; i<n; ++i)
+                    r[i]=mul(r[i],r[i]);
+          } else {
+               vector<u32> t(n,0);
+               for(size_t i=0; i<b.size(); ++i)
+                    t[i]=b[i]%P;
+               transform(t.data(),n,false);
+               for(size_t i=0; i<n; ++i)
+                    r[i]=mul(r[i],t[i]);
+          }
+          transform(r.data(),n,true);
+     }
+};
+
+///@name The Three Primes Used by ntt_multiply()
+///@{
+typedef NTT<998244353,3> NTT1;	///< 119*2^23+1
+typedef NTT<167772161,3> NTT2;	///< 5*2^25+1
+typedef NTT<469762049,3> NTT3;	///< 7*2^26+1
+///@}
+
+#ifdef __SIZEOF_INT128__
+/**\brief Multiplies two numbers given as vectors of base-*base* digits (least significant first).
+
+The convolution is computed modulo three primes, whose product (about 2^86) exceeds every coefficient of the convolution as long as base<=10^9.
+\param base The radix of the digits; at most 10^9.
+\param [out] r The a.size()+b.size() digits of the product, normalized to base *base*.
+\return false if the operands are too long for the primes' transforms (r is untouched then)
+*/
+inline bool ntt_multiply(const vector<u32>& a, const vector<u32>& b, u32 base, vector<u32>& r)
+{
+     size_t rn=a.size()+b.size();
+     size_t n=1;
+     while(n<rn)
+          n<<=1;
+     if(n>NTT1::max_len())
+          return false;
+
+     vector<u32> r1, r2, r3;
+     NTT1::convolve(a,b,n,r1);
+     NTT2::convolve(a,b,n,r2);
+     NTT3::convolve(a,b,n,r3);
+
+     //Garner's algorithm: x=x1+p1*(t2+p2*t3)
+     const u32 p1=998244353, p2=167772161, p3=469762049;
+     const u32 p1_inv_p2=NTT2::pow(p1%p2,p2-2);
+     const u32 p12_inv_p3=NTT3::pow(NTT3::mul(p1%p3,p2%p3),p3-2);
+     const u64 p12=u64(p1)*p2;
+
+     r.resize(rn);
+     u128 carry=0;
+     for(size_t i=0; i<rn; ++i) {
+          u32 t2=NTT2::mul((r2[i]+p2-r1[i]%p2)%p2,p1_inv_p2);
+          u64 x12=r1[i]+u64(p1)*t2;
+          u32 t3=NTT3::mul((r3[i]+p3-u32(x12%p3))%p3,p12_inv_p3);
+          carry+=x12+u128(p12)*t3;
+          r[i]=u32(carry%base);
+          carry/=base;
+     }
+     return true;
+}
+#endif
+
+}//namespace BigNum
+#endif /* BIGN_NTT_HPP_ */
@@ -0,0 +1,181 @@
+#ifndef BIGN_SIMD_HPP_
+#define BIGN_SIMD_HPP_
+
+#include <type_traits>
+
+#include "bign_supplemental.hpp"
+
+#ifndef SIMD_ADD
+///Whether BigN adds and subtracts cells with SSE2 or AVX2 kernels, picked at runtime (x86 with GCC or Clang only). Override with -DSIMD_ADD=0
+#define SIMD_ADD 1
+#endif
+
+#ifndef SIMD_ALIGN_THRESHOLD
+///Addend length (in cells) from which on BigN shifts the digits of the number added to, once, to line its cells up with the addend's, so that the vector kernels can do the addition. Override with -DSIMD_ALIGN_THRESHOLD=n
+#define SIMD_ALIGN_THRESHOLD 16
+#endif
+
+#if SIMD_ADD && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BIGN_SIMD_ADD_
+#endif
+
+/**
+ * \file
+ * \brief Vectorized addition and subtraction of decimal cells.
+ * Every cell gets the carry (or borrow) of its less significant neighbour, which is recomputed from an unaligned load of both operands shifted by one cell, so the vector blocks don't depend on each other.
+ * That is exact unless a carry ripples through a cell that ends up at cshift (or a borrow through one that ends up at -1); blocks with such cells are fixed up by the scalar cells_ripple().
+ */
+
+namespace BigNum {
+using namespace std;
+
+///Scalar addition of n cells of base c (most significant first): r+=x
+///\return the carry out of r[0]
+template<typename S>
+inline S cells_add_scalar(S* r, const S* x, long n, S c)
+{
+     S carry=0;
+     for(long i=n-1; i>=0; --i) {
+          r[i]+=x[i]+carry;
+          if(r[i]>=c) {
+               r[i]-=c;
+               carry=1;
+          } else
+               carry=0;
+     }
+     return carry;
+}
+///Scalar subtraction of n cells of base c (most significant first): r-=x
+///\return the borrow out of r[0]
+template<typename S>
+inline S cells_sub_scalar(S* r, const S* x, long n, S c)
+{
+     S borrow=0;
+     for(long i=n-1; i>=0; --i) {
+          S sub=x[i]+borrow;
+          if(sub>r[i]) {
+               r[i]=r[i]+c-sub;
+               borrow=1;
+          } else {
+               r[i]-=sub;
+               borrow=0;
+          }
+     }
+     return borrow;
+}
+
+#ifdef BIGN_SIMD_ADD_
+///Signed vector types of B bytes of cells (cells stay below 2^(bits-1), so signed lanes, which every instruction set compares natively, are exact), with unaligned loads and stores passed by reference, since vectors wider than the default instruction set may not be passed by value
+template<typename S, int B>
+struct CellVec {
+     typedef typename make_signed<S>::type SS;
+     typedef SS type __attribute__((vector_size(B)));
+     static inline __attribute__((always_inline)) void load(type& v, const S* p) {
+          __builtin_memcpy(&v,p,sizeof v);
+     }
+     static inline __attribute__((always_inline)) void store(S* p, const type& v) {
+          __builtin_memcpy(p,&v,sizeof v);
+     }
+};
+
+///Lets cell k, which is cshift or more (or below zero, i.e. wrapped, after a subtraction), carry into the more significant cells; a carry out of r[0] goes to out
+template<typename S>
+inline void cells_ripple(S* r, long k, S c, bool sub, S& out)
+{
+     for(; r[k]>=c; --k) {
+          r[k]= sub ? r[k]+c : r[k]-c;
+          if(!k) {
+               ++out;
+               return;
+          }
+          r[k-1]= sub ? r[k-1]-1 : r[k-1]+1;
+     }
+}
+/**\brief The body of the vectorized kernels; sub selects subtraction.
+Only ever inlined into cells_addsub_sse2() and cells_addsub_avx2(), so that it's compiled for their instruction sets.
+Carries only go to more significant cells, which have been stored already, so rippling them doesn't disturb the loads of the blocks to come.
+*/
+template<typename S, int B>
+inline __attribute__((always_inline)) S cells_addsub_vec(S* r, const S* x, long n, S c, bool sub)
+{
+     typedef CellVec<S,B> CV;
+     typedef typename CV::type V;
+     enum { L=B/sizeof(S) };
+     const V cv=V{}+typename CV::SS(c);
+     //The carry out of r[0] has to be read before r[0] changes
+     S out= sub ? r[0]<x[0] : r[0]+x[0]>=c;
+     long i=0;
+     for(; i+L<n; i+=L) {
+          V a, b, a1, b1, s;
+          CV::load(a,r+i);
+          CV::load(b,x+i);
+          CV::load(a1,r+i+1);
+          CV::load(b1,x+i+1);
+          if(sub) {
+               //Comparisons give -1 in the lanes where they hold, so adding the neighbours' borrows subtracts them
+               s=a-b+(cv&(V)(a<b))+(V)(a1<b1);
+          } else {
+               V t=a+b;
+               s=t-(cv&(V)(t>=cv))-(V)(a1+b1>=cv);
+          }
+          CV::store(r+i,s);
+          //Cells at cshift or at -1
+          V bad= sub ? (V)(s<V{}) : (V)(s>=cv);
+          u64 w[B/8], any=0;
+          __builtin_memcpy(w,&bad,B);
+          for(int k=0; k<B/8; ++k)
+               any|=w[k];
+          if(any)
+               for(long k=i+L-1; k>=i; --k)
+                    cells_ripple(r,k,c,sub,out);
+     }
+     for(; i<n; ++i) {
+          S in= i+1<n ? (sub ? r[i+1]<x[i+1] : r[i+1]+x[i+1]>=c) : 0;
+          S t= sub ? r[i]-x[i]+(r[i]<x[i] ? c : 0) : r[i]+x[i]-(r[i]+x[i]>=c ? c : 0);
+          r[i]= sub ? t-in : t+in;
+          cells_ripple(r,i,c,sub,out);
+     }
+     return out;
+}
+template<typename S>
+S cells_addsub_sse2(S* r, const S* x, long n, S c, bool sub) __attribute__((target("sse2")));
+template<typename S>
+S cells_addsub_sse2(S* r, const S* x, long n, S c, bool sub)
+{
+     return cells_addsub_vec<S,16>(r,x,n,c,sub);
+}
+template<typename S>
+S cells_addsub_avx2(S* r, const S* x, long n, S c, bool sub) __attribute__((target("avx2")));
+template<typename S>
+S cells_addsub_avx2(S* r, const S* x, long n, S c, bool sub)
+{
+     return cells_addsub_vec<S,32>(r,x,n,c,sub);
+}
+///The widest vector kernel the CPU supports for cells of the given size: 2 for AVX2, 1 for SSE2 and 0 for none (SSE2 can't compare 64-bit lanes)
+inline int simd_add_level(size_t cell_size)
+{
+     static const int level= __builtin_cpu_supports("avx2") ? 2 : __builtin_cpu_supports("sse2") ? 1 : 0;
+     return level==1 && cell_size>4 ? 0 : level;
+}
+#endif
+
+/**\brief Adds (or subtracts, if sub is true) n cells of base c, most significant first: r+=x or r-=x.
+Long arrays go through the widest vector kernel the CPU supports, short ones and other platforms through the scalar loop.
+\return the carry (or borrow) out of r[0]
+*/
+template<typename S>
+inline S cells_addsub(S* r, const S* x, long n, S c, bool sub)
+{
+#ifdef BIGN_SIMD_ADD_
+     if(n>=64/long(sizeof(S))) {
+          switch(simd_add_level(sizeof(S))) {
+          case 2: return cells_addsub_avx2(r,x,n,c,sub);
+          case 1: return cells_addsub_sse2(r,x,n,c,sub);
+          }
+     }
+#endif
+     return sub ? cells_sub_scalar(r,x,n,c) : cells_add_scalar(r,x,n,c);
+}
+
+}//namespace BigNum
+#endif /* BIGN_SIMD_HPP_ */
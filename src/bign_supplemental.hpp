@@ -4,6 +4,12 @@
 #define BIGN_SUPPLEMENTAL_HPP_
 #include <climits>
 #include <cmath>
+#include <cstring>
+
+#ifndef DIV_SCALE
+///The default number of digits behind the decimal point that BigN quotients are computed to, and the Calculator's initial scale. Override with -DDIV_SCALE=n
+#define DIV_SCALE 20
+#endif
 
 /**
  * \file
@@ -14,8 +20,17 @@
 namespace BigNum {
 using namespace std;
 
-//An extern declaration of the global pten array, which contains lower powers of ten
-extern const uintmax_t pten[];
+///\brief Holds pten; as a static member of a class template, the array is one and the same in every translation unit that uses it, although it is defined here, in a header.
+template<typename T=uintmax_t> struct PowersOfTen {
+     static constexpr T v[20]= {
+          1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL,
+          1000000000000ULL, 10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+          1000000000000000000ULL, 10000000000000000000ULL
+     };
+};
+template<typename T> constexpr T PowersOfTen<T>::v[20];
+///10^0 to 10^19, for fast lookup at run time, and in constant expressions
+constexpr const uintmax_t (&pten)[20]=PowersOfTen<>::v;
 
 ///\name Some Convenient Fixed-length Integer Typedefs
 ///@{
@@ -27,6 +42,9 @@ typedef int8_t i8;
 typedef int16_t i16;
 typedef int32_t i32;
 typedef int64_t i64;
+#ifdef __SIZEOF_INT128__
+__extension__ typedef unsigned __int128 u128; ///<Only where the compiler provides it (as GCC and Clang do on 64-bit targets)
+#endif
 ///@}
 }
 
@@ -89,26 +107,78 @@ template<> struct HalfType<u8> {
 };
 ///@}
 
-///\brief Used by IntLog.
-template< unsigned short b, unsigned long N > struct IntLog_ {
-     enum { n = 1 + IntLog_< b, N / b > :: n } ;
-} ;
-///\brief Used by IntLog.
-template<unsigned short b> struct IntLog_< b, 0 >  {
-     enum { n = 0 } ;
-} ;
-///\brief Count decimal digits in integer N at compile time.
-template< unsigned short b, unsigned long N > struct IntLog {
-     enum { n=IntLog_<b,N>::n - 1 };
+///\brief The integral part of the base-b logarithm of n>=1 (for b==10, the number of decimal digits of n, less one), in constant expressions too.
+constexpr int IntLog(unsigned long long b, unsigned long long n)
+{
+     return n<b ? 0 : 1+IntLog(b,n/b);
+}
+///\brief Raises b to the power of e>=0, in constant expressions too.
+constexpr long long Pow(long long b, int e)
+{
+     return e ? b*Pow(b,e-1) : 1;
+}
+
+///\brief A pack of indices, to expand an expression over in a constant expression (see MakeIndices).
+template<long... I> struct Indices {};
+///\brief Makes Indices<0,1 ... K-1> its *type*.
+template<long K, long... I> struct MakeIndices : MakeIndices<K-1,K-1,I...> {};
+template<long... I> struct MakeIndices<0,I...> {
+     typedef Indices<I...> type;
 };
 
-///\brief Raises "b" to the power of "e" at compile time.
-template<long long b, char e> struct Pow {
-     enum { n = b * Pow< b, e-1 >::n } ;
+///\brief The number of decimal digits that a BigN cell of type T holds: as many as fit in its lower half, so that the product of two cells fits in a cell.
+template<typename T> struct CellDigits {
+     enum { n=IntLog(10,Pow(2,sizeof(T)*8/2)-1) };
+};
+///\brief The type that BigN computes products of two cells of type T (and other double-cell intermediates) in.
+template<typename T> struct CellWideType {
+     typedef u64 type;
+};
+#if defined(DENSE_U64) && defined(__SIZEOF_INT128__)
+///With -DDENSE_U64, u64 cells hold 18 digits instead of 9: the sum of two cells and a carry still fits in a cell, and products are computed in u128.
+template<> struct CellDigits<u64> {
+     enum { n=18 };
 };
-template<long long  b> struct Pow<b, 0>  {
-     enum { n = 1 } ;
-} ;
+template<> struct CellWideType<u64> {
+     typedef u128 type;
+};
+#endif
+
+///How results are rounded to the scale of a precision context (see set_precision())
+enum round_mode {
+     ROUND_DOWN,      ///<Toward zero, i.e. truncated (as bc does)
+     ROUND_HALF_UP,   ///<To the nearest, ties away from zero
+     ROUND_HALF_EVEN, ///<To the nearest, ties to an even last digit
+     ROUND_UP,        ///<Away from zero
+     ROUND_FLOOR,     ///<Toward negative infinity
+     ROUND_CEILING    ///<Toward positive infinity
+};
+///What is cut off a number, as round_away() takes it, given the first digit cut off and whether any digit after it isn't zero
+inline int cut_rest(short first, bool sticky)
+{
+     return first>5 || (first==5 && sticky) ? 3 : first==5 ? 2 : first || sticky ? 1 : 0;
+}
+/**\brief Whether a number cut off by *mode* is rounded away from zero (to the next digit up in magnitude) rather than truncated.
+\param rest What is cut off: 0 if nothing, 1 if less than half of the last digit kept, 2 if half of it, 3 if more
+\param odd Whether the last digit kept is odd
+\param neg Whether the number is negative
+*/
+inline bool round_away(round_mode mode, int rest, bool odd, bool neg)
+{
+     switch(mode) {
+     case ROUND_HALF_UP: return rest>=2;
+     case ROUND_HALF_EVEN: return rest==3 || (rest==2 && odd);
+     case ROUND_UP: return rest>0;
+     case ROUND_FLOOR: return rest>0 && neg;
+     case ROUND_CEILING: return rest>0 && !neg;
+     default: return false;
+     }
+}
+///Makes the arithmetic of T keep *scale* digits behind the decimal point, rounded by *mode*, where that's something T can do (BigN can); x only picks T, and for other types this does nothing. Returns the scale T keeps from now on (*scale*, unless T's is fixed).
+template<typename T>
+inline long set_precision(const T&, long scale, round_mode) {
+     return scale;
+}
 
 ///\brief Computes modulos for floating point types. See integer type specializations of this template below.
 template<typename T>
@@ -126,6 +196,94 @@ INTMOD_(u8) INTMOD_(u16) INTMOD_(u32) INTMOD_(u64)
 ///@}
 #undef INTMOD_
 
+///\brief Sets q to a/b truncated toward zero and r to a-q*b, so r has the sign of a. BigN and ShrdNum overload this to divide only once.
+template<typename T>
+inline void divmod(T a, T b, T& q, T& r)
+{
+     q=a/b;
+     q= q<0 ? -floor(-q) : floor(q);
+     r=a-q*b;
+}
+
+/**\brief Multiplies the integers lo..hi together by binary splitting.
+The range is halved recursively, so the two factors of every multiplication have about the same length and fast multiplication algorithms pay off.
+\return The product in type T; 1 for an empty range (lo>hi).
+*/
+template<typename T>
+T range_product(long lo, long hi)
+{
+     if(hi-lo<4) {
+          T r=1;
+          for(; lo<=hi; ++lo)
+               r*=lo;
+          return r;
+     }
+     long mid=lo+(hi-lo)/2;
+     T r=range_product<T>(lo,mid);
+     r*=range_product<T>(mid+1,hi);
+     return r;
+}
+
+/**\name SWAR Digit Conversion
+Treat 8 (or 4) ASCII characters as one integer, so that they are checked and converted at once.
+@{*/
+///\return the end of the run of decimal digits starting at p (at most last)
+inline const char* skip_digits(const char* p, const char* last)
+{
+     for(; last-p>=8; p+=8) {
+          u64 v;
+          memcpy(&v,p,8);
+          //A byte above '9' gets its high bit set by adding 0x46, one below '0' by subtracting 0x30
+          if(((v+0x4646464646464646ULL)|(v-0x3030303030303030ULL))&0x8080808080808080ULL)
+               break;
+     }
+     while(p!=last && *p>='0' && *p<='9')
+          ++p;
+     return p;
+}
+///\return the value of the k decimal digits at p; on little-endian targets, 8 (or 4) of them are combined at a time, pairwise
+template<typename T>
+inline T digits_value(const char* p, long k)
+{
+     T r=0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__==__ORDER_LITTLE_ENDIAN__
+     for(; k>=8; k-=8, p+=8) {
+          u64 v;
+          memcpy(&v,p,8);
+          v-=0x3030303030303030ULL;
+          v=(v*10+(v>>8))&0x00FF00FF00FF00FFULL;
+          v=(v*100+(v>>16))&0x0000FFFF0000FFFFULL;
+          v=(v*10000+(v>>32))&0xFFFFFFFFULL;
+          r=T(u64(r)*100000000+v);
+     }
+     if(k>=4) {
+          u32 v;
+          memcpy(&v,p,4);
+          v-=0x30303030;
+          v=(v*10+(v>>8))&0x00FF00FF;
+          v=(v*100+(v>>16))&0xFFFF;
+          r=T(u64(r)*10000+v);
+          k-=4;
+          p+=4;
+     }
+#endif
+     for(; k; --k)
+          r=T(r*10+(*p++-'0'));
+     return r;
+}
+///@}
+///Writes the n lowest decimal digits of x, leading zeros included, to p, two at a time from a table of all pairs
+template<typename T>
+inline void fixed_digits(char* p, T x, int n)
+{
+     static const char pairs[]=
+          "0001020304050607080910111213141516171819202122232425262728293031323334353637383940414243444546474849"
+          "5051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+     for(; n>=2; n-=2, x/=100)
+          memcpy(p+n-2,pairs+2*(x%100),2);
+     if(n)
+          *p=char('0'+x%10);
+}
 ///\brief Computes the number of decimal zeros at the end of x.
 ///\tparam T The type of the x parameter.
 ///\param x The number whose ending decimal zeros should be counted.
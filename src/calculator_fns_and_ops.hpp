@@ -5,6 +5,7 @@
 #include <cassert>
 #include <cassert>
 #include <stdexcept>
+#include <limits>
 
 /**\file
  Definitions of functions that handle operators and functions in an expression. The signature of an operator handling function and the signature of a function-handling function remain the same.
@@ -12,6 +13,21 @@
 namespace BigNum {
 using namespace std;
 
+/// \brief Exception to be thrown if an integer argument doesn't fit a long.
+struct exArgRange: runtime_error {
+     exArgRange(const string& name) :
+          runtime_error(string("The argument of \"") + name + "\" doesn't fit a long.") {}
+};
+///\return x truncated to a long; throws exArgRange if the conversion saturates at its limits
+template<typename T>
+long long_arg(const T& x, const string& name)
+{
+     long r=long(x);
+     if(r==numeric_limits<long>::max() || r==numeric_limits<long>::min())
+          throw exArgRange(name);
+     return r;
+}
+
 /** \namespace Op
  * \brief A namespace for the operator functions that will be used by Calculator.
  */
@@ -50,7 +66,6 @@ All operator functions assume that the first argument is writable and disposable
  */
 #define OP_UNFUNC_(X,F_NAME)	OP_SIG_(F_NAME) 	{*x = X(*x);}
 OP_FUNC_(*,times) 	///< Multiplication
-/*OP_FUNC_(%,mod)*/	///< Modulo
 OP_FUNC_(/,div)		///< Division
 OP_FUNC_(-,minus)	///< Subtraction	
 OP_FUNC_(+,plus)	///< Addition
@@ -67,7 +82,6 @@ OP_AFUNC_(+=,aplus)	///< +=
 OP_AFUNC_(-=,aminus)	///< -=
 OP_AFUNC_(*=,atimes)	///< *=
 OP_AFUNC_(/=,adiv)	///< /=
-//OP_AFUNC_(%=,amod)	///< %u
 OP_UNFUNC_(+,uplus)	///< Unary Plus
 OP_UNFUNC_(-,uminus)	///< Unary Minus
 OP_UNFUNC_(!,ulnot)	///< (Unary ) Logical Negation
@@ -75,25 +89,50 @@ OP_UNFUNC_(!,ulnot)	///< (Unary ) Logical Negation
 ///A no-op function
 OP_SIG_(noop) {}
 
-///^, Raise x to the power of y
-/// only works with integral exponents
-/*^*/ OP_SIG_(raise)
+///Modulo; the remainder of x/y truncated to an integer
+OP_SIG_(mod)
+{
+     T q;
+     divmod(*x,*y,q,*x);
+}
+///%=
+OP_SIG_(amod)
 {
+     mod(x,y);
+}
 
-     T b=1;
-     T c=*x;
-     for(int i=*y; i>0; --i)
-          b*=c;
-     *x=b;
+/**^, Raise x to the power of y by binary exponentiation.
+The exponent is truncated to an integer and scanned from its top bit down, so every step is a squaring, possibly followed by a multiplication by x.
+A negative exponent yields the reciprocal of the power.*/
+/*^*/ OP_SIG_(raise)
+{
+     T e, bit, one=1, two=2;
+     e=*y;	//a copy of the value; copy-constructed ShrdNums would share it
+     divmod(e,one,e,bit);
+     bool negative= e<0;
+     if(negative)
+          e=-e;
+     vector<bool> bits;
+     while(bool(e)) {
+          divmod(e,two,e,bit);
+          bits.push_back(bool(bit));
+     }
+     T r=1;
+     for(auto it=bits.rbegin(); it!=bits.rend(); ++it) {
+          r*=r;
+          if(*it)
+               r*=*x;
+     }
+     if(negative) {
+          *x=1;
+          *x/=r;
+     } else
+          *x=r;
 }
-///Calculate the factorial of x
+///Calculate the factorial of x (truncated to an integer) as the product of 2..x
 OP_SIG_(ofact)
 {
-     T tmp=1;
-     T one=1;
-     for(; *x>one; --(*x))
-          tmp*=*x;
-     *x=tmp;
+     *x=range_product<T>(2,long_arg(*x,"!"));
 }
 #undef OP_SIG_
 #undef OP_FUNC_
@@ -131,6 +170,15 @@ FDEFEND_()
 FDEFBEG_(fact,1)
 BigNum::Op::ofact<T>(args[0],NULL);
 FDEFEND_()
+///Divide two arguments, truncating the quotient to an integer; the remainder is stored in the *rem* variable
+FDEFBEG_(divmod,2)
+using BigNum::divmod;
+divmod(*args[0],*args[1],*args[0],*args[2]);
+FDEFEND_()
+///Multiply the integers from the first argument to the second one
+FDEFBEG_(prod,2)
+*args[0]=range_product<T>(long_arg(*args[0],"prod"),long_arg(*args[1],"prod"));
+FDEFEND_()
 ///Output help text
 FDEFBEG_(help,0)
 cout<<"Welcome to my calculator!";
@@ -193,6 +193,18 @@ int Calculator<T>::_run(bool should_print)
           return FAILURE;
      }
 
+     //The statement's temporaries take their storage from arena_; once they are gone, the variables (ans included) move theirs out of it, and it is reset
+     struct ArenaStatement {
+          Calculator& c;
+          CellArena::Scope scope;
+          ArenaStatement(Calculator& calc) : c(calc), scope(&calc.arena_) {}
+          ~ArenaStatement() {
+               for(auto it=c.vars_.begin(); it!=c.vars_.end(); ++it)
+                    leave_arena(it->second);
+               c.arena_.reset();
+          }
+     } statement(*this);
+     _set_precision();
      CalcStackType comp_stack;
 
      auto it=rpn_.begin();
@@ -210,6 +222,11 @@ int Calculator<T>::_run(bool should_print)
 	  string id=valref.id();
 	  T *p=valref.get_scratch_p(*this); 
 	  assign(ans_,*p);
+	  //What is shown of scale and round is what the precision context takes of them
+	  if(id=="scale" || id=="round") {
+	       _set_precision();
+	       assign(ans_,id=="scale" ? scale_ : round_);
+	  }
 	  
 	  if(should_print){
 	    if(id.length())
@@ -247,6 +264,8 @@ int Calculator<T>::ReadAndComp(istream& is)
 
      Stack<const Tk*> opstack; //operator stack
      //output (rpn line)
+     //The numbers of the tokens are temporaries too: they come from arena_, which _run resets at the end of the statement (and the catch below, if it fails to parse)
+     CellArena::Scope scope(&arena_);
 
      eState state=WANT_VAL;
 
@@ -312,8 +331,9 @@ int Calculator<T>::ReadAndComp(istream& is)
                          if(state!=HAVE_VAL)
                               throw typename OpT::exInvalidOp(id);
                          argsn++;
-                         //POP until opstack.top()->to_str()=="(" or opstack.empty()
+                         //POP to rpn_ until opstack.top()->to_str()=="(" or opstack.empty()
                          while(!opstack.empty() && opstack.top()->to_str()!="(") {
+                              rpn_.push_back(const_cast<Tk*>(static_cast<const Tk*>(opstack.top())));
                               opstack.pop();
                          }
                          state=WANT_VAL;
@@ -432,6 +452,7 @@ int Calculator<T>::ReadAndComp(istream& is)
                     ;;
                _clear_tp_vec(rpn_);
                _clear_tp_vec(opstack.v_);
+               arena_.reset();
                state=WANT_VAL;
           }
 
@@ -32,7 +32,7 @@ This will most likely be either **unsigned char** or **uintmax_t**. While using
 for addition and subtraction, both formally and performance-wise equivalent to that of **bc**, it is rather wasteful in terms of storage efficiency.
 Using larger data types makes BigNum more efficient both in terms of storage space economy and performance, especially when it comes to multiplication.
 (Addition and subtraction are actually slightly slower, possibly due to somewhat more involved shifting).
-On my 64 bit computer , BigNum with 64-bit cells computes products  (even if they're thousands of digits long') about three times faster than *bc*, despite the fact that, unlike bc, BigNum  only uses long multiplication.
+On my 64 bit computer , BigNum with 64-bit cells computes products  (even if they're thousands of digits long') about three times faster than *bc*. Long operands (longer than KARATSUBA_THRESHOLD cells) are multiplied by Karatsuba multiplication instead of long multiplication.
 
 The Calculator class exposes its functionality by providing a user interface that accepts standardly formatted arithmetic formulae.
 It is again, a templated class, which means that BigNum::BigN<>'s can be seamlessly swapped for any other numerical type, and the Calculator will then work with that type instead. Using native types should lead to virtually no performance loss, as the Calculator class will work with those types directly, without using pointers. Since this is counterproductive for large types such as BigN or std::valarrays, for instance, the ShrdNum class is presented, which represents a thin wrapper around numerical types that exposes their functionality but only stores *std::shared_ptr*'s internally. This speeds up copying of large numerical types significantly.
@@ -52,6 +52,8 @@ The Calculator provides standard template code for all basic numerical operators
 #include "Calculator.hpp"
 #include "ShrdNum.hpp"
 #include "BigN.hpp"
+#include "BigInt.hpp"
+#include "BigFixed.hpp"
 #include <iostream>
 #include <fstream>
 
@@ -75,8 +77,25 @@ using namespace BigNum;
 #define STYPE u8
 #endif
 
+#ifndef FIXED_DIGITS
+///How many decimal digits BigFixed numbers have with USE_BIGFIXED
+#define FIXED_DIGITS 38
+#endif
+#ifndef FIXED_SCALE
+///How many of them are behind the decimal point
+#define FIXED_SCALE DIV_SCALE
+#endif
+
+#ifdef USE_BIGINT
+/// SBigN—a shared BigInt, if the USE_BIGINT macro is defined: integers only, stored in binary
+typedef ShrdNum<BigInt> SBigN;
+#elif defined(USE_BIGFIXED)
+/// SBigN—a BigFixed, if the USE_BIGFIXED macro is defined: FIXED_DIGITS digits, FIXED_SCALE of them behind the decimal point. It is small and needs no heap, so it is used as it is, unshared.
+typedef BigFixed<FIXED_DIGITS,FIXED_SCALE> SBigN;
+#else
 /// SBigN—a shared BigN—a type that will behave as a number but will internally manage  pointers to shared storage
-typedef ShrdNum<BigN<STYPE>> SBigN;
+typedef ShrdNum<BigN<STYPE,ArenaAllocator<STYPE> > > SBigN;
+#endif
 /// Calc—instantiate the Calculator to use SBigN to represent its numbers
 typedef Calculator<SBigN> Calc;
 